@@ -6,8 +6,8 @@
 using namespace Rcpp;
 
 // adult_weight_wrapper
-List adult_weight_wrapper(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, double days, bool checkValues);
-RcppExport SEXP _bw_adult_weight_wrapper(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP daysSEXP, SEXP checkValuesSEXP) {
+List adult_weight_wrapper(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, double days, bool checkValues, std::string method, List control, IntegerVector rmrEquation, IntegerVector inputColumn);
+RcppExport SEXP _bw_adult_weight_wrapper(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP daysSEXP, SEXP checkValuesSEXP, SEXP methodSEXP, SEXP controlSEXP, SEXP rmrEquationSEXP, SEXP inputColumnSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -23,13 +23,17 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
     Rcpp::traits::input_parameter< double >::type days(daysSEXP);
     Rcpp::traits::input_parameter< bool >::type checkValues(checkValuesSEXP);
-    rcpp_result_gen = Rcpp::wrap(adult_weight_wrapper(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, days, checkValues));
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< List >::type control(controlSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rmrEquation(rmrEquationSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type inputColumn(inputColumnSEXP);
+    rcpp_result_gen = Rcpp::wrap(adult_weight_wrapper(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, days, checkValues, method, control, rmrEquation, inputColumn));
     return rcpp_result_gen;
 END_RCPP
 }
 // adult_weight_wrapper_EI
-List adult_weight_wrapper_EI(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, NumericVector extradata, double days, bool checkValues, bool isEnergy);
-RcppExport SEXP _bw_adult_weight_wrapper_EI(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP extradataSEXP, SEXP daysSEXP, SEXP checkValuesSEXP, SEXP isEnergySEXP) {
+List adult_weight_wrapper_EI(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, NumericVector extradata, double days, bool checkValues, bool isEnergy, std::string method, List control, IntegerVector rmrEquation, IntegerVector inputColumn);
+RcppExport SEXP _bw_adult_weight_wrapper_EI(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP extradataSEXP, SEXP daysSEXP, SEXP checkValuesSEXP, SEXP isEnergySEXP, SEXP methodSEXP, SEXP controlSEXP, SEXP rmrEquationSEXP, SEXP inputColumnSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -47,13 +51,17 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type days(daysSEXP);
     Rcpp::traits::input_parameter< bool >::type checkValues(checkValuesSEXP);
     Rcpp::traits::input_parameter< bool >::type isEnergy(isEnergySEXP);
-    rcpp_result_gen = Rcpp::wrap(adult_weight_wrapper_EI(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, extradata, days, checkValues, isEnergy));
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< List >::type control(controlSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rmrEquation(rmrEquationSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type inputColumn(inputColumnSEXP);
+    rcpp_result_gen = Rcpp::wrap(adult_weight_wrapper_EI(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, extradata, days, checkValues, isEnergy, method, control, rmrEquation, inputColumn));
     return rcpp_result_gen;
 END_RCPP
 }
 // adult_weight_wrapper_EI_fat
-List adult_weight_wrapper_EI_fat(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, NumericVector input_EI, NumericVector input_fat, double days, bool checkValues);
-RcppExport SEXP _bw_adult_weight_wrapper_EI_fat(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP input_EISEXP, SEXP input_fatSEXP, SEXP daysSEXP, SEXP checkValuesSEXP) {
+List adult_weight_wrapper_EI_fat(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, NumericVector input_EI, NumericVector input_fat, double days, bool checkValues, std::string method, List control, IntegerVector rmrEquation, IntegerVector inputColumn);
+RcppExport SEXP _bw_adult_weight_wrapper_EI_fat(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP input_EISEXP, SEXP input_fatSEXP, SEXP daysSEXP, SEXP checkValuesSEXP, SEXP methodSEXP, SEXP controlSEXP, SEXP rmrEquationSEXP, SEXP inputColumnSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -71,13 +79,66 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< NumericVector >::type input_fat(input_fatSEXP);
     Rcpp::traits::input_parameter< double >::type days(daysSEXP);
     Rcpp::traits::input_parameter< bool >::type checkValues(checkValuesSEXP);
-    rcpp_result_gen = Rcpp::wrap(adult_weight_wrapper_EI_fat(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, input_EI, input_fat, days, checkValues));
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< List >::type control(controlSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rmrEquation(rmrEquationSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type inputColumn(inputColumnSEXP);
+    rcpp_result_gen = Rcpp::wrap(adult_weight_wrapper_EI_fat(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, input_EI, input_fat, days, checkValues, method, control, rmrEquation, inputColumn));
+    return rcpp_result_gen;
+END_RCPP
+}
+// adult_intake_wrapper
+List adult_intake_wrapper(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, double days, IntegerVector id, NumericVector time, NumericVector weight, List control, IntegerVector rmrEquation);
+RcppExport SEXP _bw_adult_intake_wrapper(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP daysSEXP, SEXP idSEXP, SEXP timeSEXP, SEXP weightSEXP, SEXP controlSEXP, SEXP rmrEquationSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type bw(bwSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type ht(htSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type age(ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type sex(sexSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type EIchange(EIchangeSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type NAchange(NAchangeSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type PAL(PALSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type pcarb_base(pcarb_baseSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type pcarb(pcarbSEXP);
+    Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
+    Rcpp::traits::input_parameter< double >::type days(daysSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type id(idSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type time(timeSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type weight(weightSEXP);
+    Rcpp::traits::input_parameter< List >::type control(controlSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rmrEquation(rmrEquationSEXP);
+    rcpp_result_gen = Rcpp::wrap(adult_intake_wrapper(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, days, id, time, weight, control, rmrEquation));
+    return rcpp_result_gen;
+END_RCPP
+}
+// adult_stream_wrapper
+List adult_stream_wrapper(NumericVector bw, NumericVector ht, NumericVector age, NumericVector sex, NumericMatrix EIchange, NumericMatrix NAchange, NumericMatrix PAL, NumericVector pcarb_base, NumericVector pcarb, double dt, double days, int every, IntegerVector rmrEquation);
+RcppExport SEXP _bw_adult_stream_wrapper(SEXP bwSEXP, SEXP htSEXP, SEXP ageSEXP, SEXP sexSEXP, SEXP EIchangeSEXP, SEXP NAchangeSEXP, SEXP PALSEXP, SEXP pcarb_baseSEXP, SEXP pcarbSEXP, SEXP dtSEXP, SEXP daysSEXP, SEXP everySEXP, SEXP rmrEquationSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type bw(bwSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type ht(htSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type age(ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type sex(sexSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type EIchange(EIchangeSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type NAchange(NAchangeSEXP);
+    Rcpp::traits::input_parameter< NumericMatrix >::type PAL(PALSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type pcarb_base(pcarb_baseSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type pcarb(pcarbSEXP);
+    Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
+    Rcpp::traits::input_parameter< double >::type days(daysSEXP);
+    Rcpp::traits::input_parameter< int >::type every(everySEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rmrEquation(rmrEquationSEXP);
+    rcpp_result_gen = Rcpp::wrap(adult_stream_wrapper(bw, ht, age, sex, EIchange, NAchange, PAL, pcarb_base, pcarb, dt, days, every, rmrEquation));
     return rcpp_result_gen;
 END_RCPP
 }
 // child_weight_wrapper
-List child_weight_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, NumericMatrix input_EIntake, double days, double dt, bool checkValues, double referenceValues);
-RcppExport SEXP _bw_child_weight_wrapper(SEXP ageSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP FFMSEXP, SEXP FMSEXP, SEXP input_EIntakeSEXP, SEXP daysSEXP, SEXP dtSEXP, SEXP checkValuesSEXP, SEXP referenceValuesSEXP) {
+List child_weight_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, NumericMatrix input_EIntake, double days, double dt, bool checkValues, std::string referenceValues, std::string method, List control);
+RcppExport SEXP _bw_child_weight_wrapper(SEXP ageSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP FFMSEXP, SEXP FMSEXP, SEXP input_EIntakeSEXP, SEXP daysSEXP, SEXP dtSEXP, SEXP checkValuesSEXP, SEXP referenceValuesSEXP, SEXP methodSEXP, SEXP controlSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -90,14 +151,16 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type days(daysSEXP);
     Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
     Rcpp::traits::input_parameter< bool >::type checkValues(checkValuesSEXP);
-    Rcpp::traits::input_parameter< double >::type referenceValues(referenceValuesSEXP);
-    rcpp_result_gen = Rcpp::wrap(child_weight_wrapper(age, sex, bmiCat, FFM, FM, input_EIntake, days, dt, checkValues, referenceValues));
+    Rcpp::traits::input_parameter< std::string >::type referenceValues(referenceValuesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(child_weight_wrapper(age, sex, bmiCat, FFM, FM, input_EIntake, days, dt, checkValues, referenceValues, method, control));
     return rcpp_result_gen;
 END_RCPP
 }
 // child_weight_wrapper_richardson
-List child_weight_wrapper_richardson(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double K, double Q, double A, double B, double nu, double C, double days, double dt, bool checkValues, double referenceValues);
-RcppExport SEXP _bw_child_weight_wrapper_richardson(SEXP ageSEXP, SEXP sexSEXP,  SEXP bmiCatSEXP, SEXP FFMSEXP, SEXP FMSEXP, SEXP KSEXP, SEXP QSEXP, SEXP ASEXP, SEXP BSEXP, SEXP nuSEXP, SEXP CSEXP, SEXP daysSEXP, SEXP dtSEXP, SEXP checkValuesSEXP, SEXP referenceValuesSEXP) {
+List child_weight_wrapper_richardson(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double K, double Q, double A, double B, double nu, double C, double days, double dt, bool checkValues, std::string referenceValues, std::string method, List control);
+RcppExport SEXP _bw_child_weight_wrapper_richardson(SEXP ageSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP FFMSEXP, SEXP FMSEXP, SEXP KSEXP, SEXP QSEXP, SEXP ASEXP, SEXP BSEXP, SEXP nuSEXP, SEXP CSEXP, SEXP daysSEXP, SEXP dtSEXP, SEXP checkValuesSEXP, SEXP referenceValuesSEXP, SEXP methodSEXP, SEXP controlSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -115,13 +178,15 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type days(daysSEXP);
     Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
     Rcpp::traits::input_parameter< bool >::type checkValues(checkValuesSEXP);
-    Rcpp::traits::input_parameter< double >::type referenceValues(referenceValuesSEXP);
-    rcpp_result_gen = Rcpp::wrap(child_weight_wrapper_richardson(age, sex, bmiCat, FFM, FM, K, Q, A, B, nu, C, days, dt, checkValues, referenceValues));
+    Rcpp::traits::input_parameter< std::string >::type referenceValues(referenceValuesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< List >::type control(controlSEXP);
+    rcpp_result_gen = Rcpp::wrap(child_weight_wrapper_richardson(age, sex, bmiCat, FFM, FM, K, Q, A, B, nu, C, days, dt, checkValues, referenceValues, method, control));
     return rcpp_result_gen;
 END_RCPP
 }
 // intake_reference_wrapper
-NumericMatrix intake_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double days, double dt, double referenceValues);
+NumericMatrix intake_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double days, double dt, std::string referenceValues);
 RcppExport SEXP _bw_intake_reference_wrapper(SEXP ageSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP FFMSEXP, SEXP FMSEXP, SEXP daysSEXP, SEXP dtSEXP, SEXP referenceValuesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
@@ -133,52 +198,365 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< NumericVector >::type FM(FMSEXP);
     Rcpp::traits::input_parameter< double >::type days(daysSEXP);
     Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
-    Rcpp::traits::input_parameter< double >::type  referenceValues(referenceValuesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type referenceValues(referenceValuesSEXP);
     rcpp_result_gen = Rcpp::wrap(intake_reference_wrapper(age, sex, bmiCat, FFM, FM, days, dt, referenceValues));
     return rcpp_result_gen;
 END_RCPP
 }
 // mass_reference_wrapper
-List mass_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, double referenceValues);
-RcppExport SEXP _bw_mass_reference_wrapper(SEXP ageSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP  referenceValuesSEXP) {
+List mass_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, std::string referenceValues);
+RcppExport SEXP _bw_mass_reference_wrapper(SEXP ageSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP referenceValuesSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericVector >::type age(ageSEXP);
     Rcpp::traits::input_parameter< NumericVector >::type sex(sexSEXP);
     Rcpp::traits::input_parameter< NumericVector >::type bmiCat(bmiCatSEXP);
-    Rcpp::traits::input_parameter< double >::type referenceValues(referenceValuesSEXP);
+    Rcpp::traits::input_parameter< std::string >::type referenceValues(referenceValuesSEXP);
     rcpp_result_gen = Rcpp::wrap(mass_reference_wrapper(age, sex, bmiCat, referenceValues));
     return rcpp_result_gen;
 END_RCPP
 }
+// risk_wrapper
+List risk_wrapper(NumericMatrix BMI, List risk, NumericVector TIME, int threads);
+RcppExport SEXP _bw_risk_wrapper(SEXP BMISEXP, SEXP riskSEXP, SEXP TIMESEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type BMI(BMISEXP);
+    Rcpp::traits::input_parameter< List >::type risk(riskSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type TIME(TIMESEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(risk_wrapper(BMI, risk, TIME, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // EnergyBuilder
-NumericMatrix EnergyBuilder(NumericMatrix Energy, NumericVector Time, std::string interpol);
-RcppExport SEXP _bw_EnergyBuilder(SEXP EnergySEXP, SEXP TimeSEXP, SEXP interpolSEXP) {
+NumericMatrix EnergyBuilder(NumericMatrix Energy, NumericVector Time, std::string interpol, double dt);
+RcppExport SEXP _bw_EnergyBuilder(SEXP EnergySEXP, SEXP TimeSEXP, SEXP interpolSEXP, SEXP dtSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
     Rcpp::traits::input_parameter< NumericMatrix >::type Energy(EnergySEXP);
     Rcpp::traits::input_parameter< NumericVector >::type Time(TimeSEXP);
     Rcpp::traits::input_parameter< std::string >::type interpol(interpolSEXP);
-    rcpp_result_gen = Rcpp::wrap(EnergyBuilder(Energy, Time, interpol));
+    Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
+    rcpp_result_gen = Rcpp::wrap(EnergyBuilder(Energy, Time, interpol, dt));
+    return rcpp_result_gen;
+END_RCPP
+}
+// output_layout_wrapper
+List output_layout_wrapper(List model, std::string layout, IntegerVector tile);
+RcppExport SEXP _bw_output_layout_wrapper(SEXP modelSEXP, SEXP layoutSEXP, SEXP tileSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< std::string >::type layout(layoutSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type tile(tileSEXP);
+    rcpp_result_gen = Rcpp::wrap(output_layout_wrapper(model, layout, tile));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pce_basis_wrapper
+IntegerMatrix pce_basis_wrapper(int dim, int degree, double q);
+RcppExport SEXP _bw_pce_basis_wrapper(SEXP dimSEXP, SEXP degreeSEXP, SEXP qSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type dim(dimSEXP);
+    Rcpp::traits::input_parameter< int >::type degree(degreeSEXP);
+    Rcpp::traits::input_parameter< double >::type q(qSEXP);
+    rcpp_result_gen = Rcpp::wrap(pce_basis_wrapper(dim, degree, q));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pce_quadrature_wrapper
+List pce_quadrature_wrapper(int family, int n);
+RcppExport SEXP _bw_pce_quadrature_wrapper(SEXP familySEXP, SEXP nSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type family(familySEXP);
+    Rcpp::traits::input_parameter< int >::type n(nSEXP);
+    rcpp_result_gen = Rcpp::wrap(pce_quadrature_wrapper(family, n));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pce_design_wrapper
+NumericMatrix pce_design_wrapper(NumericMatrix points, IntegerVector families, IntegerMatrix basis, int threads);
+RcppExport SEXP _bw_pce_design_wrapper(SEXP pointsSEXP, SEXP familiesSEXP, SEXP basisSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type points(pointsSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type families(familiesSEXP);
+    Rcpp::traits::input_parameter< IntegerMatrix >::type basis(basisSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(pce_design_wrapper(points, families, basis, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// pce_fit_wrapper
+List pce_fit_wrapper(NumericMatrix Psi, NumericVector y, bool sparse);
+RcppExport SEXP _bw_pce_fit_wrapper(SEXP PsiSEXP, SEXP ySEXP, SEXP sparseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericMatrix >::type Psi(PsiSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< bool >::type sparse(sparseSEXP);
+    rcpp_result_gen = Rcpp::wrap(pce_fit_wrapper(Psi, y, sparse));
+    return rcpp_result_gen;
+END_RCPP
+}
+// reference_pack_register_wrapper
+void reference_pack_register_wrapper(std::string name, NumericVector sex, NumericVector bmiCat, NumericVector age, NumericVector FFM, NumericVector FM);
+RcppExport SEXP _bw_reference_pack_register_wrapper(SEXP nameSEXP, SEXP sexSEXP, SEXP bmiCatSEXP, SEXP ageSEXP, SEXP FFMSEXP, SEXP FMSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type sex(sexSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type bmiCat(bmiCatSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type age(ageSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type FFM(FFMSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type FM(FMSEXP);
+    reference_pack_register_wrapper(name, sex, bmiCat, age, FFM, FM);
+    return R_NilValue;
+END_RCPP
+}
+// reference_pack_names_wrapper
+CharacterVector reference_pack_names_wrapper();
+RcppExport SEXP _bw_reference_pack_names_wrapper() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(reference_pack_names_wrapper());
+    return rcpp_result_gen;
+END_RCPP
+}
+// run_monitor_wrapper
+SEXP run_monitor_wrapper(CharacterVector variables, int capacity);
+RcppExport SEXP _bw_run_monitor_wrapper(SEXP variablesSEXP, SEXP capacitySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< CharacterVector >::type variables(variablesSEXP);
+    Rcpp::traits::input_parameter< int >::type capacity(capacitySEXP);
+    rcpp_result_gen = Rcpp::wrap(run_monitor_wrapper(variables, capacity));
+    return rcpp_result_gen;
+END_RCPP
+}
+// run_monitor_cancel_wrapper
+bool run_monitor_cancel_wrapper(SEXP monitor);
+RcppExport SEXP _bw_run_monitor_cancel_wrapper(SEXP monitorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type monitor(monitorSEXP);
+    rcpp_result_gen = Rcpp::wrap(run_monitor_cancel_wrapper(monitor));
+    return rcpp_result_gen;
+END_RCPP
+}
+// run_monitor_progress_wrapper
+List run_monitor_progress_wrapper(SEXP monitor);
+RcppExport SEXP _bw_run_monitor_progress_wrapper(SEXP monitorSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type monitor(monitorSEXP);
+    rcpp_result_gen = Rcpp::wrap(run_monitor_progress_wrapper(monitor));
+    return rcpp_result_gen;
+END_RCPP
+}
+// run_monitor_aggregates_wrapper
+List run_monitor_aggregates_wrapper(SEXP monitor, double dt);
+RcppExport SEXP _bw_run_monitor_aggregates_wrapper(SEXP monitorSEXP, SEXP dtSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type monitor(monitorSEXP);
+    Rcpp::traits::input_parameter< double >::type dt(dtSEXP);
+    rcpp_result_gen = Rcpp::wrap(run_monitor_aggregates_wrapper(monitor, dt));
+    return rcpp_result_gen;
+END_RCPP
+}
+// shared_input_available_wrapper
+bool shared_input_available_wrapper();
+RcppExport SEXP _bw_shared_input_available_wrapper() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(shared_input_available_wrapper());
+    return rcpp_result_gen;
+END_RCPP
+}
+// shared_input_wrapper
+SEXP shared_input_wrapper(NumericVector x);
+RcppExport SEXP _bw_shared_input_wrapper(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< NumericVector >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(shared_input_wrapper(x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// shared_input_attach_wrapper
+SEXP shared_input_attach_wrapper(std::string name);
+RcppExport SEXP _bw_shared_input_attach_wrapper(SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(shared_input_attach_wrapper(name));
+    return rcpp_result_gen;
+END_RCPP
+}
+// shared_input_info_wrapper
+SEXP shared_input_info_wrapper(SEXP x);
+RcppExport SEXP _bw_shared_input_info_wrapper(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(shared_input_info_wrapper(x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// shared_input_release_wrapper
+bool shared_input_release_wrapper(SEXP x);
+RcppExport SEXP _bw_shared_input_release_wrapper(SEXP xSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type x(xSEXP);
+    rcpp_result_gen = Rcpp::wrap(shared_input_release_wrapper(x));
+    return rcpp_result_gen;
+END_RCPP
+}
+// regression_wrapper
+List regression_wrapper(List model, List regression, NumericVector TIME, int threads);
+RcppExport SEXP _bw_regression_wrapper(SEXP modelSEXP, SEXP regressionSEXP, SEXP TIMESEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< List >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< List >::type regression(regressionSEXP);
+    Rcpp::traits::input_parameter< NumericVector >::type TIME(TIMESEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(regression_wrapper(model, regression, TIME, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// thread_budget_wrapper
+int thread_budget_wrapper(int budget, double process, bool worker);
+RcppExport SEXP _bw_thread_budget_wrapper(SEXP budgetSEXP, SEXP processSEXP, SEXP workerSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< int >::type budget(budgetSEXP);
+    Rcpp::traits::input_parameter< double >::type process(processSEXP);
+    Rcpp::traits::input_parameter< bool >::type worker(workerSEXP);
+    rcpp_result_gen = Rcpp::wrap(thread_budget_wrapper(budget, process, worker));
+    return rcpp_result_gen;
+END_RCPP
+}
+// thread_pool_stop_wrapper
+void thread_pool_stop_wrapper();
+RcppExport SEXP _bw_thread_pool_stop_wrapper() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    thread_pool_stop_wrapper();
+    return R_NilValue;
+END_RCPP
+}
+// zone_map_wrapper
+List zone_map_wrapper(RObject x, IntegerVector block);
+RcppExport SEXP _bw_zone_map_wrapper(SEXP xSEXP, SEXP blockSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type x(xSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type block(blockSEXP);
+    rcpp_result_gen = Rcpp::wrap(zone_map_wrapper(x, block));
+    return rcpp_result_gen;
+END_RCPP
+}
+// zone_query_wrapper
+IntegerVector zone_query_wrapper(RObject x, List map, std::string op, double value, std::string when, int first, int last);
+RcppExport SEXP _bw_zone_query_wrapper(SEXP xSEXP, SEXP mapSEXP, SEXP opSEXP, SEXP valueSEXP, SEXP whenSEXP, SEXP firstSEXP, SEXP lastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type x(xSEXP);
+    Rcpp::traits::input_parameter< List >::type map(mapSEXP);
+    Rcpp::traits::input_parameter< std::string >::type op(opSEXP);
+    Rcpp::traits::input_parameter< double >::type value(valueSEXP);
+    Rcpp::traits::input_parameter< std::string >::type when(whenSEXP);
+    Rcpp::traits::input_parameter< int >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< int >::type last(lastSEXP);
+    rcpp_result_gen = Rcpp::wrap(zone_query_wrapper(x, map, op, value, when, first, last));
     return rcpp_result_gen;
 END_RCPP
 }
+// zone_summary_wrapper
+List zone_summary_wrapper(RObject x, List map, IntegerVector rows, int first, int last);
+RcppExport SEXP _bw_zone_summary_wrapper(SEXP xSEXP, SEXP mapSEXP, SEXP rowsSEXP, SEXP firstSEXP, SEXP lastSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< RObject >::type x(xSEXP);
+    Rcpp::traits::input_parameter< List >::type map(mapSEXP);
+    Rcpp::traits::input_parameter< IntegerVector >::type rows(rowsSEXP);
+    Rcpp::traits::input_parameter< int >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< int >::type last(lastSEXP);
+    rcpp_result_gen = Rcpp::wrap(zone_summary_wrapper(x, map, rows, first, last));
+    return rcpp_result_gen;
+END_RCPP
+}
+
+void shared_input_init(DllInfo* dll);
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_bw_adult_weight_wrapper", (DL_FUNC) &_bw_adult_weight_wrapper, 12},
-    {"_bw_adult_weight_wrapper_EI", (DL_FUNC) &_bw_adult_weight_wrapper_EI, 14},
-    {"_bw_adult_weight_wrapper_EI_fat", (DL_FUNC) &_bw_adult_weight_wrapper_EI_fat, 14},
-    {"_bw_child_weight_wrapper", (DL_FUNC) &_bw_child_weight_wrapper, 10},
-    {"_bw_child_weight_wrapper_richardson", (DL_FUNC) &_bw_child_weight_wrapper_richardson, 15},
+    {"_bw_adult_weight_wrapper", (DL_FUNC) &_bw_adult_weight_wrapper, 16},
+    {"_bw_adult_weight_wrapper_EI", (DL_FUNC) &_bw_adult_weight_wrapper_EI, 18},
+    {"_bw_adult_weight_wrapper_EI_fat", (DL_FUNC) &_bw_adult_weight_wrapper_EI_fat, 18},
+    {"_bw_adult_intake_wrapper", (DL_FUNC) &_bw_adult_intake_wrapper, 16},
+    {"_bw_adult_stream_wrapper", (DL_FUNC) &_bw_adult_stream_wrapper, 13},
+    {"_bw_child_weight_wrapper", (DL_FUNC) &_bw_child_weight_wrapper, 12},
+    {"_bw_child_weight_wrapper_richardson", (DL_FUNC) &_bw_child_weight_wrapper_richardson, 17},
     {"_bw_intake_reference_wrapper", (DL_FUNC) &_bw_intake_reference_wrapper, 8},
     {"_bw_mass_reference_wrapper", (DL_FUNC) &_bw_mass_reference_wrapper, 4},
-    {"_bw_EnergyBuilder", (DL_FUNC) &_bw_EnergyBuilder, 3},
+    {"_bw_risk_wrapper", (DL_FUNC) &_bw_risk_wrapper, 4},
+    {"_bw_EnergyBuilder", (DL_FUNC) &_bw_EnergyBuilder, 4},
+    {"_bw_output_layout_wrapper", (DL_FUNC) &_bw_output_layout_wrapper, 3},
+    {"_bw_pce_basis_wrapper", (DL_FUNC) &_bw_pce_basis_wrapper, 3},
+    {"_bw_pce_quadrature_wrapper", (DL_FUNC) &_bw_pce_quadrature_wrapper, 2},
+    {"_bw_pce_design_wrapper", (DL_FUNC) &_bw_pce_design_wrapper, 4},
+    {"_bw_pce_fit_wrapper", (DL_FUNC) &_bw_pce_fit_wrapper, 3},
+    {"_bw_reference_pack_register_wrapper", (DL_FUNC) &_bw_reference_pack_register_wrapper, 6},
+    {"_bw_reference_pack_names_wrapper", (DL_FUNC) &_bw_reference_pack_names_wrapper, 0},
+    {"_bw_run_monitor_wrapper", (DL_FUNC) &_bw_run_monitor_wrapper, 2},
+    {"_bw_run_monitor_cancel_wrapper", (DL_FUNC) &_bw_run_monitor_cancel_wrapper, 1},
+    {"_bw_run_monitor_progress_wrapper", (DL_FUNC) &_bw_run_monitor_progress_wrapper, 1},
+    {"_bw_run_monitor_aggregates_wrapper", (DL_FUNC) &_bw_run_monitor_aggregates_wrapper, 2},
+    {"_bw_shared_input_available_wrapper", (DL_FUNC) &_bw_shared_input_available_wrapper, 0},
+    {"_bw_shared_input_wrapper", (DL_FUNC) &_bw_shared_input_wrapper, 1},
+    {"_bw_shared_input_attach_wrapper", (DL_FUNC) &_bw_shared_input_attach_wrapper, 1},
+    {"_bw_shared_input_info_wrapper", (DL_FUNC) &_bw_shared_input_info_wrapper, 1},
+    {"_bw_shared_input_release_wrapper", (DL_FUNC) &_bw_shared_input_release_wrapper, 1},
+    {"_bw_regression_wrapper", (DL_FUNC) &_bw_regression_wrapper, 4},
+    {"_bw_thread_budget_wrapper", (DL_FUNC) &_bw_thread_budget_wrapper, 3},
+    {"_bw_thread_pool_stop_wrapper", (DL_FUNC) &_bw_thread_pool_stop_wrapper, 0},
+    {"_bw_zone_map_wrapper", (DL_FUNC) &_bw_zone_map_wrapper, 2},
+    {"_bw_zone_query_wrapper", (DL_FUNC) &_bw_zone_query_wrapper, 7},
+    {"_bw_zone_summary_wrapper", (DL_FUNC) &_bw_zone_summary_wrapper, 5},
     {NULL, NULL, 0}
 };
 
 RcppExport void R_init_bw(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    shared_input_init(dll);
 }
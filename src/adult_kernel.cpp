@@ -0,0 +1,423 @@
+//
+//  adult_kernel.cpp
+//
+//  This is a scalar (one individual at a time) version of the right hand
+//  side of the adult model in adult_weight.cpp. Equations are kept in the
+//  same order as in Adult so that rk4Step reproduces Adult::rk4.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Chow, Carson C, and Kevin D Hall. 2008. “The Dynamics of Human Body Weight Change.” PLoS Comput Biol 4 (3):e1000045.
+//
+//  Hall, Kevin D. 2010. “Predicting Metabolic Adaptation, Body Weight Change, and Energy Intake in Humans.”
+//      American Journal of Physiology-Endocrinology and Metabolism 298 (3). Am Physiological Soc: E449–E466.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include "adult_kernel.h"
+#include "energy_source.h"
+
+AdultKernel::AdultKernel(void){
+
+}
+
+AdultKernel::AdultKernel(AdultParameters input_parameters, AdultInputs input_inputs){
+    par = input_parameters;
+    in  = input_inputs;
+}
+
+//Step of the inputs corresponding to time t
+int AdultKernel::row(double t) const {
+    int r = floor(t/in.dt);
+    if (r > in.nrow - 1){
+        r = in.nrow - 1;
+    }
+    return r;
+}
+
+//Change in calories
+double AdultKernel::deltaEI(double t) const {
+    if (in.EIsource != NULL){
+        return in.EIsource->value(in.column, t);
+    }
+    return in.EIchange[row(t)*in.stride];
+}
+
+//Change in sodium
+double AdultKernel::deltaNA(double t) const {
+    return in.NAchange[row(t)*in.stride];
+}
+
+//Physical activity
+double AdultKernel::deltaPAL(double t) const {
+    return in.PAL[row(t)*in.stride];
+}
+
+//Total energy intake
+double AdultKernel::TotalIntake(double t) const {
+    return par.EI + deltaEI(t);
+}
+
+//Carbohydrate intake
+double AdultKernel::CI(double t) const {
+    return par.pcarb * TotalIntake(t);
+}
+
+//Get fat mass as function of lean tissue
+double AdultKernel::fatMass(double L) const {
+    return par.fat * exp(par.roL * (L - par.lean)/(par.roF * par.C));
+}
+
+double AdultKernel::bodyWeight(const AdultState& y) const {
+    return fatMass(y.L) + y.L + y.ECF + 3.7*y.G;
+}
+
+//Adaptive Thermogenesis derivative
+double AdultKernel::dAT(double t, double AT) const {
+    return (par.betaAT*deltaEI(t) - AT)*(1.0/par.tauAT);
+}
+
+//Extracellular fluid derivative
+double AdultKernel::dECF(double t, double ECF) const {
+    return (deltaNA(t) - par.zetaNa*(ECF - par.ecfinit) - par.zetaCI*(1.0 - CI(t)/par.CIb))/par.Na;
+}
+
+//Glycogen
+double AdultKernel::dG(double t, double G) const {
+    return (CI(t) - par.kG*pow(G, 2.0))/par.roG;
+}
+
+//R helper for Lean derivative (see Adult::R and Adult::delta_times_bw)
+double AdultKernel::R(double t, double L, double G, double AT, double ECF) const {
+    double F     = fatMass(L);
+    double coef  = (1 - par.betaTEF)*deltaPAL(t) - 1;
+    double rmr_t = restingMetabolicRate(par.rmr, F + L + 3.7*G + ECF, par.ht, par.age + t/365, par.sex);
+    double R3    = par.K + coef*rmr_t + par.betaTEF*deltaEI(t) + AT - TotalIntake(t) + dG(t, G);
+    return (R3 + par.gammaL*L + par.gammaF*F)/(par.alfa1 + par.alfa2*F);
+}
+
+//Lean tissue derivative
+double AdultKernel::dL(double t, double L, double G, double AT, double ECF) const {
+    return R(t, L, G, AT, ECF)*(par.C/par.roL);
+}
+
+//Runge Kutta 4 step with the same splitting as Adult::rk4: AT, ECF and G
+//are advanced first and lean mass uses their averages at the half step.
+void AdultKernel::rk4Step(double t, double h, AdultState& y) const {
+
+    double k1, k2, k3, k4;
+    AdultState y1;
+
+    //Adaptive thermogenesis
+    k1   = dAT(t, y.AT);
+    k2   = dAT(t + 0.5 * h, y.AT + 0.5 * h * k1);
+    k3   = dAT(t + 0.5 * h, y.AT + 0.5 * h * k2);
+    k4   = dAT(t + h, y.AT + h * k3);
+    y1.AT = y.AT + h * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+
+    //Extracellular fluid
+    k1   = dECF(t, y.ECF);
+    k2   = dECF(t + 0.5 * h, y.ECF + 0.5 * h * k1);
+    k3   = dECF(t + 0.5 * h, y.ECF + 0.5 * h * k2);
+    k4   = dECF(t + h, y.ECF + h * k3);
+    y1.ECF = y.ECF + h * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+
+    //Glycogen
+    k1   = dG(t, y.G);
+    k2   = dG(t + 0.5 * h, y.G + 0.5 * h * k1);
+    k3   = dG(t + 0.5 * h, y.G + 0.5 * h * k2);
+    k4   = dG(t + h, y.G + h * k3);
+    y1.G = y.G + h * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+
+    //Lean mass
+    k1   = dL(t, y.L, y.G, y.AT, y.ECF);
+    k2   = dL(t + 0.5 * h, y.L + 0.5 * h * k1, 0.5*(y1.G + y.G), 0.5*(y1.AT + y.AT), 0.5*(y1.ECF + y.ECF));
+    k3   = dL(t + 0.5 * h, y.L + 0.5 * h * k2, 0.5*(y1.G + y.G), 0.5*(y1.AT + y.AT), 0.5*(y1.ECF + y.ECF));
+    k4   = dL(t + h, y.L + h * k3, y1.G, y1.AT, y1.ECF);
+    y1.L = y.L + h * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+
+    y = y1;
+}
+
+//2N-storage Runge Kutta step: all states advance together at each stage
+void AdultKernel::lowStorageStep(double t, double h, const LowStorageScheme& scheme,
+                                 AdultState& y) const {
+
+    AdultState dy = {0.0, 0.0, 0.0, 0.0};
+
+    for (int s = 0; s < scheme.stages; s++){
+        const double ts = t + scheme.c[s]*h;
+
+        //Derivatives at the stage (dL first as it uses all the states)
+        double fL   = dL(ts, y.L, y.G, y.AT, y.ECF);
+        double fAT  = dAT(ts, y.AT);
+        double fECF = dECF(ts, y.ECF);
+        double fG   = dG(ts, y.G);
+
+        dy.AT  = scheme.A[s]*dy.AT  + h*fAT;
+        dy.ECF = scheme.A[s]*dy.ECF + h*fECF;
+        dy.G   = scheme.A[s]*dy.G   + h*fG;
+        dy.L   = scheme.A[s]*dy.L   + h*fL;
+
+        y.AT  += scheme.B[s]*dy.AT;
+        y.ECF += scheme.B[s]*dy.ECF;
+        y.G   += scheme.B[s]*dy.G;
+        y.L   += scheme.B[s]*dy.L;
+    }
+}
+
+//Cubic Hermite interpolation at s in [0, 1] of a step of size H
+static double hermite(double s, double H, double y0, double f0, double y1, double f1){
+    double s2 = s*s, s3 = s2*s;
+    return (2.0*s3 - 3.0*s2 + 1.0)*y0 + (s3 - 2.0*s2 + s)*H*f0 +
+           (3.0*s2 - 2.0*s3)*y1 + (s3 - s2)*H*f1;
+}
+
+//Multirate step of H = m*h. Extracellular fluid and glycogen relax in days
+//while adaptive thermogenesis and lean mass change over weeks, so:
+//  1. The fast states (ECF and G, which do not depend on the slow ones) take
+//     m Runge Kutta 4 steps of size h.
+//  2. AT (which depends only on itself) takes one Runge Kutta 4 step of size H.
+//  3. Lean mass takes one Runge Kutta 4 step of size H with ECF and G of the
+//     substeps at its stage times and AT from the cubic Hermite interpolant
+//     of step 2 (fastest first coupling).
+//The slow states at the substeps are interpolated (cubic Hermite). Inputs are
+//evaluated at the stage times only so they should change slower than H for
+//lean mass and AT.
+void AdultKernel::multirateStep(double t, double h, int m, AdultState& y, AdultState* states) const {
+
+    const double H = m*h;
+    double k1, k2, k3, k4;
+
+    //Fast states
+    states[0] = y;
+    for (int j = 1; j <= m; j++){
+        const double tj = t + (j - 1)*h;
+        const AdultState& x = states[j - 1];
+
+        k1 = dECF(tj, x.ECF);
+        k2 = dECF(tj + 0.5 * h, x.ECF + 0.5 * h * k1);
+        k3 = dECF(tj + 0.5 * h, x.ECF + 0.5 * h * k2);
+        k4 = dECF(tj + h, x.ECF + h * k3);
+        states[j].ECF = x.ECF + h * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+
+        k1 = dG(tj, x.G);
+        k2 = dG(tj + 0.5 * h, x.G + 0.5 * h * k1);
+        k3 = dG(tj + 0.5 * h, x.G + 0.5 * h * k2);
+        k4 = dG(tj + h, x.G + h * k3);
+        states[j].G = x.G + h * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+    }
+
+    //Fast states at the half step (mean of the substeps around it when m is odd)
+    const int a = m/2, b = (m + 1)/2;
+    const double Gmid   = 0.5*(states[a].G + states[b].G);
+    const double ECFmid = 0.5*(states[a].ECF + states[b].ECF);
+
+    //Adaptive thermogenesis
+    k1 = dAT(t, y.AT);
+    k2 = dAT(t + 0.5 * H, y.AT + 0.5 * H * k1);
+    k3 = dAT(t + 0.5 * H, y.AT + 0.5 * H * k2);
+    k4 = dAT(t + H, y.AT + H * k3);
+    const double AT1   = y.AT + H * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+    const double fAT0  = k1;
+    const double fAT1  = dAT(t + H, AT1);
+    const double ATmid = hermite(0.5, H, y.AT, fAT0, AT1, fAT1);
+
+    //Lean mass
+    const AdultState& z = states[m];
+    k1 = dL(t, y.L, y.G, y.AT, y.ECF);
+    k2 = dL(t + 0.5 * H, y.L + 0.5 * H * k1, Gmid, ATmid, ECFmid);
+    k3 = dL(t + 0.5 * H, y.L + 0.5 * H * k2, Gmid, ATmid, ECFmid);
+    k4 = dL(t + H, y.L + H * k3, z.G, AT1, z.ECF);
+    const double L1  = y.L + H * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+    const double fL0 = k1;
+    const double fL1 = dL(t + H, L1, z.G, AT1, z.ECF);
+
+    //Slow states at the substeps
+    for (int j = 1; j <= m; j++){
+        const double s = (double) j/m;
+        states[j].AT = hermite(s, H, y.AT, fAT0, AT1, fAT1);
+        states[j].L  = hermite(s, H, y.L, fL0, L1, fL1);
+    }
+    states[m].AT = AT1;
+    states[m].L  = L1;
+
+    y = states[m];
+}
+
+//Linearly implicit Euler step: y1 = y + h f(y)/(1 - h J) where J is the
+//diagonal of the Jacobian. AT, ECF and G are linear or quadratic in themselves
+//so their J is exact; for lean mass it is approximated by central differences.
+void AdultKernel::coarseStep(double t, double h, AdultState& y) const {
+
+    const double eps = 1.e-4;
+
+    double fAT  = dAT(t, y.AT);
+    double fECF = dECF(t, y.ECF);
+    double fG   = dG(t, y.G);
+    double fL   = dL(t, y.L, y.G, y.AT, y.ECF);
+
+    double jAT  = -1.0/par.tauAT;
+    double jECF = -par.zetaNa/par.Na;
+    double jG   = -2.0*par.kG*y.G/par.roG;
+    double jL   = (dL(t, y.L + eps, y.G, y.AT, y.ECF) - dL(t, y.L - eps, y.G, y.AT, y.ECF))/(2.0*eps);
+
+    //Lean mass is only damped; never amplify
+    if (jL > 0){
+        jL = 0;
+    }
+
+    y.AT  = y.AT  + h*fAT/(1.0 - h*jAT);
+    y.ECF = y.ECF + h*fECF/(1.0 - h*jECF);
+    y.G   = y.G   + h*fG/(1.0 - h*jG);
+    y.L   = y.L   + h*fL/(1.0 - h*jL);
+}
+
+//Glycogen and ECF where dG and dECF vanish with the inputs of time t
+void AdultKernel::equilibrium(double t, AdultState& z) const {
+    const double ci = CI(t);
+    z.G   = ci > 0 ? sqrt(ci/par.kG) : 0.0;
+    z.ECF = par.ecfinit + (deltaNA(t) - par.zetaCI*(1.0 - ci/par.CIb))/par.zetaNa;
+}
+
+//AT, ECF and glycogen of y after s days with the inputs of time t. AT and ECF
+//are linear in themselves and glycogen is a Riccati equation
+//roG G' = CI - kG G^2 so the three have closed form solutions.
+void AdultKernel::exactFlow(double t, double s, const AdultState& y, AdultState& z) const {
+
+    //Adaptive thermogenesis relaxes to betaAT*deltaEI
+    const double ATeq = par.betaAT*deltaEI(t);
+    z.AT = ATeq + (y.AT - ATeq)*exp(-s/par.tauAT);
+
+    //Extracellular fluid relaxes to the value where sodium is balanced
+    AdultState eq;
+    equilibrium(t, eq);
+    z.ECF = eq.ECF + (y.ECF - eq.ECF)*exp(-par.zetaNa*s/par.Na);
+
+    //Glycogen
+    const double ci = CI(t);
+    if (ci > 0){
+        const double g  = sqrt(ci/par.kG);
+        const double th = tanh(par.kG*g*s/par.roG);
+        z.G = g*(y.G + g*th)/(g + y.G*th);
+    } else if (ci < 0){
+        const double w = sqrt(-ci/par.kG);
+        z.G = w*tan(atan(y.G/w) - par.kG*w*s/par.roG);
+    } else {
+        z.G = y.G/(1.0 + par.kG*y.G*s/par.roG);
+    }
+
+    z.L = y.L;
+}
+
+//phi_k(z) = (exp(z) - sum_{j<k} z^j/j!)/z^k for k = 1, 2, 3. The series is
+//used near 0 where the closed form cancels.
+static void phiFunctions(double z, double& phi1, double& phi2, double& phi3){
+    if (fabs(z) < 0.5){
+        double term = 1.0, fact = 1.0;
+        phi1 = 0; phi2 = 0; phi3 = 0;
+        for (int n = 0; n < 16; n++){
+            phi1 += term/(fact*(n + 1));
+            phi2 += term/(fact*(n + 1)*(n + 2));
+            phi3 += term/(fact*(n + 1)*(n + 2)*(n + 3));
+            term *= z;
+            fact *= n + 1;
+        }
+    } else {
+        const double ez = exp(z);
+        phi1 = (ez - 1.0)/z;
+        phi2 = (ez - 1.0 - z)/(z*z);
+        phi3 = (ez - 1.0 - z - 0.5*z*z)/(z*z*z);
+    }
+}
+
+//Exponential step. AT, ECF and glycogen follow exactFlow. Lean mass is split
+//as L' = c L + N(t, L) with c the derivative of dL in L at the start of the
+//step (central differences) and advanced with the fourth order exponential
+//time differencing Runge Kutta scheme of Cox and Matthews (2002) using the
+//exact fast states at its stage times. The end of the step is evaluated just
+//inside it so that all stages use the inputs of row(t).
+void AdultKernel::exponentialStep(double t, double h, AdultState& y) const {
+
+    const double eps = 1.e-4;
+    const double tm  = t + 0.5*h;
+    const double te  = t + h - 1.e-6*h;
+
+    AdultState mid, end;
+    exactFlow(t, 0.5*h, y, mid);
+    exactFlow(t, h, y, end);
+
+    //Linear part of lean mass
+    const double c = (dL(t, y.L + eps, y.G, y.AT, y.ECF) - dL(t, y.L - eps, y.G, y.AT, y.ECF))/(2.0*eps);
+
+    double phi1, phi2, phi3, half1, half2, half3;
+    phiFunctions(c*h, phi1, phi2, phi3);
+    phiFunctions(0.5*c*h, half1, half2, half3);
+    const double E  = exp(c*h);
+    const double E2 = exp(0.5*c*h);
+
+    //Stages (N is the nonlinear remainder)
+    const double Nu = dL(t, y.L, y.G, y.AT, y.ECF) - c*y.L;
+    const double a  = E2*y.L + 0.5*h*half1*Nu;
+    const double Nm = dL(tm, a, mid.G, mid.AT, mid.ECF) - c*a;
+    const double b  = E2*y.L + 0.5*h*half1*Nm;
+    const double Nb = dL(tm, b, mid.G, mid.AT, mid.ECF) - c*b;
+    const double d  = E2*a + 0.5*h*half1*(2.0*Nb - Nu);
+    const double Nd = dL(te, d, end.G, end.AT, end.ECF) - c*d;
+
+    end.L = E*y.L + h*((phi1 - 3.0*phi2 + 4.0*phi3)*Nu +
+                       2.0*(phi2 - 2.0*phi3)*(Nm + Nb) +
+                       (4.0*phi3 - phi2)*Nd);
+
+    y = end;
+}
+
+//Quasi steady state step. Glycogen and ECF relax in days so over long horizons
+//they are slaved to their equilibria (singular perturbation reduction) and
+//only the slow system in lean mass and AT remains. AT is linear so it is
+//advanced exactly as in exponentialStep; lean mass takes a Runge Kutta 4 step
+//with AT at the stage times. All stages use the inputs of row(t).
+void AdultKernel::quasiSteadyStep(double t, double h, AdultState& y) const {
+
+    const double tm = t + 0.5*h;
+    const double te = t + h - 1.e-6*h;
+
+    AdultState mid, end;
+    exactFlow(t, 0.5*h, y, mid);
+    exactFlow(t, h, y, end);
+    equilibrium(t, mid);
+    equilibrium(t, end);
+
+    //The start of the step is also at equilibrium (except at baseline)
+    AdultState start = y;
+    equilibrium(t, start);
+
+    double k1 = dL(t, y.L, start.G, y.AT, start.ECF);
+    double k2 = dL(tm, y.L + 0.5*h*k1, mid.G, mid.AT, mid.ECF);
+    double k3 = dL(tm, y.L + 0.5*h*k2, mid.G, mid.AT, mid.ECF);
+    double k4 = dL(te, y.L + h*k3, end.G, end.AT, end.ECF);
+    end.L = y.L + h*(k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+
+    y = end;
+}
@@ -0,0 +1,159 @@
+//
+//  adult_kernel.h
+//
+//  This is a scalar (one individual at a time) version of the right hand
+//  side of the adult model in adult_weight.cpp. It contains no R objects
+//  so it can be evaluated from worker threads.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef adult_kernel_h
+#define adult_kernel_h
+
+#include <math.h>
+#include "energy_equations.h"
+#include "low_storage_rk.h"
+
+class EnergySource;
+
+//States of the adult model for one individual
+//--------------------------------------------------------------------------------
+struct AdultState {
+    double AT;      //Adaptive thermogenesis (kcal)
+    double ECF;     //Extracellular fluid (kg)
+    double G;       //Glycogen (kg)
+    double L;       //Lean mass (kg)
+};
+
+//Constants of one individual (see Adult for their meaning)
+//--------------------------------------------------------------------------------
+struct AdultParameters {
+
+    //Individual constants
+    double ht;
+    double age;
+    double sex;
+    double EI;
+    double K;
+    double kG;
+    double CIb;
+    double pcarb;
+    double ecfinit;
+    double fat;
+    double lean;
+    int    rmr;     //Code of the RMR equation (see energy_equations.h)
+
+    //Population constants
+    double roG;
+    double Na;
+    double zetaNa;
+    double zetaCI;
+    double roF;
+    double roL;
+    double gammaF;
+    double gammaL;
+    double betaTEF;
+    double betaAT;
+    double tauAT;
+    double C;
+    double alfa1;
+    double alfa2;
+};
+
+//EIchange, NAchange and PAL of one individual: nrow time steps of size dt
+//(the same as in Adult) stride values apart. When EIsource is given the
+//intake change is interpolated at the time asked instead of read from its
+//step (row column of the source, see energy_source.h).
+//--------------------------------------------------------------------------------
+struct AdultInputs {
+    const double* EIchange;
+    const double* NAchange;
+    const double* PAL;
+    int    nrow;
+    int    stride;
+    double dt;
+    const EnergySource* EIsource;
+    int    column;
+};
+
+//Right hand side and time step of the adult model for one individual
+//--------------------------------------------------------------------------------
+class AdultKernel {
+public:
+
+    AdultKernel(void);
+    AdultKernel(AdultParameters input_parameters, AdultInputs input_inputs);
+
+    AdultParameters par;
+    AdultInputs     in;
+
+    //Inputs at time t
+    double deltaEI(double t) const;
+    double deltaNA(double t) const;
+    double deltaPAL(double t) const;
+    double TotalIntake(double t) const;
+    double CI(double t) const;
+
+    //Model equations
+    double fatMass(double L) const;
+    double bodyWeight(const AdultState& y) const;
+    double dAT(double t, double AT) const;
+    double dECF(double t, double ECF) const;
+    double dG(double t, double G) const;
+    double dL(double t, double L, double G, double AT, double ECF) const;
+
+    //Same Runge Kutta 4 step as Adult::rk4
+    void rk4Step(double t, double h, AdultState& y) const;
+
+    //Step of a 2N-storage Runge Kutta scheme of the coupled system (see
+    //low_storage_rk.h). Only y and one register per state are used.
+    void lowStorageStep(double t, double h, const LowStorageScheme& scheme, AdultState& y) const;
+
+    //Multirate step of m substeps of size h (see adult_kernel.cpp). states gets
+    //the m + 1 states of the substeps (including y at t).
+    void multirateStep(double t, double h, int m, AdultState& y, AdultState* states) const;
+
+    //Cheap coarse step (linearly implicit Euler on the diagonal of the Jacobian)
+    //which is stable for steps much larger than the ones allowed by rk4Step
+    void coarseStep(double t, double h, AdultState& y) const;
+
+    //Exponential step with the inputs of row(t) held over the step: AT, ECF and
+    //glycogen are advanced exactly and lean mass with exponential time
+    //differencing (see adult_kernel.cpp). Stable for any h.
+    void exponentialStep(double t, double h, AdultState& y) const;
+
+    //Step of the reduced model where glycogen and ECF are at the equilibrium
+    //of the inputs of row(t) (quasi steady state). AT is advanced exactly and
+    //lean mass with Runge Kutta 4.
+    void quasiSteadyStep(double t, double h, AdultState& y) const;
+
+private:
+    int    row(double t) const;
+    void   exactFlow(double t, double s, const AdultState& y, AdultState& z) const;
+    void   equilibrium(double t, AdultState& z) const;
+    double R(double t, double L, double G, double AT, double ECF) const;
+};
+
+#endif /* adult_kernel_h */
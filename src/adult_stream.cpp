@@ -0,0 +1,145 @@
+//
+//  adult_stream.cpp
+//
+//  Step by step integration of the adult model (see adult_stream.h).
+//  The steps are the same as in Adult::rk4.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <stdexcept>
+#include "adult_stream.h"
+
+AdultStream::AdultStream(const std::vector<AdultKernel>& input_kernels,
+                         const std::vector<AdultState>& initial, int input_nsteps,
+                         int input_every){
+    
+    if (input_kernels.size() != initial.size()){
+        throw std::invalid_argument("AdultStream: one initial state per kernel is needed.");
+    }
+    if (input_nsteps < 0 || input_every < 1){
+        throw std::invalid_argument("AdultStream: invalid number of steps.");
+    }
+    
+    kernels  = input_kernels;
+    states   = initial;
+    nsteps   = input_nsteps;
+    every    = input_every;
+    current  = 0;
+    dt       = kernels.empty() ? 1.0 : kernels[0].in.dt;
+    started  = false;
+    finished = false;
+}
+
+bool AdultStream::next(void){
+    
+    //The first call yields the initial states
+    if (!started){
+        started = true;
+        return true;
+    }
+    
+    if (current >= nsteps){
+        finished = true;
+        return false;
+    }
+    
+    //Advance every steps (or up to the last step)
+    const int last = current + every < nsteps ? current + every : nsteps;
+    for (; current < last; current++){
+        const double t = current*dt;
+        for (size_t i = 0; i < states.size(); i++){
+            kernels[i].rk4Step(t, dt, states[i]);
+        }
+    }
+    
+    return true;
+}
+
+int AdultStream::step(void) const {
+    return current;
+}
+
+double AdultStream::time(void) const {
+    return current*dt;
+}
+
+bool AdultStream::done(void) const {
+    return finished;
+}
+
+int AdultStream::size(void) const {
+    return (int) states.size();
+}
+
+const AdultState& AdultStream::state(int i) const {
+    return states[i];
+}
+
+double AdultStream::fatMass(int i) const {
+    return kernels[i].fatMass(states[i].L);
+}
+
+double AdultStream::bodyWeight(int i) const {
+    return kernels[i].bodyWeight(states[i]);
+}
+
+AdultStream::iterator AdultStream::begin(void){
+    if (!next()){
+        return end();
+    }
+    return iterator(this);
+}
+
+AdultStream::iterator AdultStream::end(void){
+    return iterator(NULL);
+}
+
+//Iterator
+//--------------------------------------------------------------------------------
+AdultStream::iterator::iterator(AdultStream* input_stream){
+    stream = input_stream;
+}
+
+const AdultStream& AdultStream::iterator::operator*(void) const {
+    return *stream;
+}
+
+const AdultStream* AdultStream::iterator::operator->(void) const {
+    return stream;
+}
+
+AdultStream::iterator& AdultStream::iterator::operator++(void){
+    if (!stream->next()){
+        stream = NULL;
+    }
+    return *this;
+}
+
+bool AdultStream::iterator::operator==(const iterator& other) const {
+    return stream == other.stream;
+}
+
+bool AdultStream::iterator::operator!=(const iterator& other) const {
+    return stream != other.stream;
+}
@@ -0,0 +1,103 @@
+//
+//  adult_stream.h
+//
+//  Step by step (pull) integration of the adult model for a block of
+//  individuals. Each call to next() advances the states and only the
+//  current step is kept so a host program can read the states, update
+//  other models and continue without storing trajectories. It uses
+//  AdultKernel so it contains no R objects.
+//
+//  Example:
+//      AdultStream stream(kernels, initial, nsteps);
+//      for (AdultStream::iterator it = stream.begin(); it != stream.end(); ++it){
+//          for (int i = 0; i < it->size(); i++){
+//              use(it->time(), it->bodyWeight(i));
+//          }
+//      }
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef adult_stream_h
+#define adult_stream_h
+
+#include <vector>
+#include "adult_kernel.h"
+
+//Pull iterator over the steps of the adult model
+//--------------------------------------------------------------------------------
+class AdultStream {
+public:
+
+    //Kernels and initial states of each individual; nsteps steps of size
+    //kernels[i].in.dt are integrated and every "every" steps are yielded.
+    //The inputs pointed by the kernels must outlive the stream.
+    AdultStream(const std::vector<AdultKernel>& input_kernels,
+                const std::vector<AdultState>& initial, int input_nsteps,
+                int input_every = 1);
+
+    //Advances to the next yielded step. Returns false when there are no more
+    //steps (the states are then left at the last one).
+    bool next(void);
+
+    //Current step
+    int    step(void) const;
+    double time(void) const;
+    bool   done(void) const;
+    int    size(void) const;
+
+    //States of individual i at the current step
+    const AdultState& state(int i) const;
+    double fatMass(int i) const;
+    double bodyWeight(int i) const;
+
+    //Iterator over the yielded steps (starting at step 0) so that the stream
+    //can be used in a for loop. Dereferencing gives the stream itself.
+    class iterator {
+    public:
+        iterator(AdultStream* input_stream);
+        const AdultStream& operator*(void) const;
+        const AdultStream* operator->(void) const;
+        iterator& operator++(void);
+        bool operator==(const iterator& other) const;
+        bool operator!=(const iterator& other) const;
+    private:
+        AdultStream* stream;
+    };
+
+    iterator begin(void);
+    iterator end(void);
+
+private:
+    std::vector<AdultKernel> kernels;
+    std::vector<AdultState>  states;
+    int    nsteps;      //Total number of steps
+    int    every;       //Steps between yielded steps
+    int    current;     //Current step
+    double dt;          //Time step (days)
+    bool   started;     //Whether begin() or next() have been called
+    bool   finished;    //Whether the last step was passed
+};
+
+#endif /* adult_stream_h */
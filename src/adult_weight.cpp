@@ -10,7 +10,7 @@
 //  ht              .-  Height (m).
 //  age             .-  Years since individual first arrived to Earth.
 //  sex             .-  Either 1 = "female" or 0 = "male".
-//  EIchange        .-  Change in energy intake (kcal).
+//  EIchange        .-  Change in energy intake (kcal); one row per individual and column per step.
 //  NAchange        .-  Change in sodium consumption (mg).
 //  PAL             .-  Physical activity level. (Between 1.4 and 2.4)
 //  pcarb           .-  Proportion of carbohydrates from diet throughout the time the model runs.
@@ -62,17 +62,28 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //----------------------------------------------------------------------------------------
 
+#include <thread>
 #include "adult_weight.h"
+#include "parareal.h"
+#include "control.h"
+#include "trajectory_recorder.h"
+#include "category_runs.h"
+#include "thread_governor.h"
+#include "energy_residual.h"
 
 //Default Constructor for an Adult.
 Adult::Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
              NumericVector sexstring, NumericMatrix input_EIchange,
              NumericMatrix input_NAchange, NumericMatrix physicalactivity,
-             NumericVector percentc, NumericVector percentb, double input_dt, bool checkValues){
+             NumericVector percentc, NumericVector percentb, double input_dt, bool checkValues,
+             IntegerVector input_rmrEquation, IntegerVector input_inputColumn,
+             List input_parameters){
     
     //Build model from parameters
+    parameters = input_parameters;
     build(weight, height, age_yrs, sexstring, input_EIchange, input_NAchange,
-          physicalactivity, percentc, percentb, input_dt, checkValues);
+          physicalactivity, percentc, percentb, input_dt, checkValues, input_rmrEquation,
+          input_inputColumn);
     
 }
 
@@ -81,12 +92,15 @@ Adult::Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
              NumericVector sexstring, NumericMatrix input_EIchange,
              NumericMatrix input_NAchange, NumericMatrix physicalactivity,
              NumericVector percentc, NumericVector percentb, double input_dt, NumericVector extradata,
-             bool checkValues, bool isEnergy){
+             bool checkValues, bool isEnergy, IntegerVector input_rmrEquation,
+             IntegerVector input_inputColumn, List input_parameters){
     
     
     //Build model from parameters
+    parameters = input_parameters;
     build(weight, height, age_yrs, sexstring, input_EIchange, input_NAchange,
-          physicalactivity, percentc, percentb, input_dt, extradata, checkValues, isEnergy);
+          physicalactivity, percentc, percentb, input_dt, extradata, checkValues, isEnergy,
+          input_rmrEquation, input_inputColumn);
     
 }
 
@@ -95,12 +109,15 @@ Adult::Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
              NumericVector sexstring, NumericMatrix input_EIchange,
              NumericMatrix input_NAchange, NumericMatrix physicalactivity,
              NumericVector percentc, NumericVector percentb, double input_dt, NumericVector input_EI,
-             NumericVector input_fat, bool checkValues){
+             NumericVector input_fat, bool checkValues, IntegerVector input_rmrEquation,
+             IntegerVector input_inputColumn, List input_parameters){
     
     
     //Build model from parameters
+    parameters = input_parameters;
     build(weight, height, age_yrs, sexstring, input_EIchange, input_NAchange,
-          physicalactivity, percentc, percentb, input_dt ,input_EI, input_fat, checkValues);
+          physicalactivity, percentc, percentb, input_dt ,input_EI, input_fat, checkValues,
+          input_rmrEquation, input_inputColumn);
     
 }
 
@@ -108,7 +125,8 @@ Adult::Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
 void Adult::build(NumericVector weight, NumericVector height, NumericVector age_yrs,
                   NumericVector sexstring, NumericMatrix input_EIchange,
                   NumericMatrix input_NAchange, NumericMatrix physicalactivity,
-                  NumericVector percentc, NumericVector percentb, double input_dt, bool checkValues){
+                  NumericVector percentc, NumericVector percentb, double input_dt, bool checkValues,
+             IntegerVector input_rmrEquation, IntegerVector input_inputColumn){
     
     //Assign parameters
     dt         = input_dt; //Time step set to 1 because of matrix use (each time is a row in EIchange)
@@ -122,6 +140,8 @@ void Adult::build(NumericVector weight, NumericVector height, NumericVector age_
     pcarb      = percentc;
     pcarb_base = percentb;
     check      = checkValues;
+    rmrEquation = input_rmrEquation;
+    inputColumn = input_inputColumn;
     
     //Get energy
     getParameters();
@@ -141,7 +161,8 @@ void Adult::build(NumericVector weight, NumericVector height, NumericVector age_
                   NumericVector sexstring, NumericMatrix input_EIchange,
                   NumericMatrix input_NAchange, NumericMatrix physicalactivity,
                   NumericVector percentc, NumericVector percentb, double input_dt,
-                  NumericVector extradata, bool checkValues, bool isEnergy){
+                  NumericVector extradata, bool checkValues, bool isEnergy,
+                  IntegerVector input_rmrEquation, IntegerVector input_inputColumn){
     
     //Assign parameters
     dt         = input_dt; //For rk4
@@ -155,6 +176,8 @@ void Adult::build(NumericVector weight, NumericVector height, NumericVector age_
     pcarb      = percentc;
     pcarb_base = percentb;
     check      = checkValues;
+    rmrEquation = input_rmrEquation;
+    inputColumn = input_inputColumn;
     
     //Get additional information
     getParameters();
@@ -188,7 +211,8 @@ void Adult::build(NumericVector weight, NumericVector height, NumericVector age_
                   NumericVector sexstring, NumericMatrix input_EIchange,
                   NumericMatrix input_NAchange, NumericMatrix physicalactivity,
                   NumericVector percentc, NumericVector percentb, double input_dt,
-                  NumericVector input_EI, NumericVector input_fat, bool checkValues){
+                  NumericVector input_EI, NumericVector input_fat, bool checkValues,
+                  IntegerVector input_rmrEquation, IntegerVector input_inputColumn){
     
     //Assign parameters
     dt         = input_dt; //For rk4
@@ -202,6 +226,8 @@ void Adult::build(NumericVector weight, NumericVector height, NumericVector age_
     pcarb      = percentc;
     pcarb_base = percentb;
     check      = checkValues;
+    rmrEquation = input_rmrEquation;
+    inputColumn = input_inputColumn;
     
     //Get additional information
     getParameters();
@@ -229,6 +255,11 @@ void Adult::getParameters(void){
     //Get size of model
     nind    = bw.size();
     
+    //Mifflin St Jeor by default
+    if (rmrEquation.size() == 0){
+        rmrEquation = IntegerVector(nind, RMR_MIFFLIN);
+    }
+    
     //Set to true
     
     //Initialize other variables that are not dependent on the individual
@@ -245,30 +276,66 @@ void Adult::getParameters(void){
     betaTEF = 0.1;
     betaAT  = 0.14;
     tauAT   = 14.0;
+    
+    //Values given in control$parameters (e.g. to propagate their uncertainty)
+    parameter("roG", roG);
+    parameter("Na", Na);
+    parameter("zetaNa", zetaNa);
+    parameter("zetaCI", zetaCI);
+    parameter("roF", roF);
+    parameter("roL", roL);
+    parameter("gammaF", gammaF);
+    parameter("gammaL", gammaL);
+    parameter("etaF", etaF);
+    parameter("etaL", etaL);
+    parameter("betaTEF", betaTEF);
+    parameter("betaAT", betaAT);
+    parameter("tauAT", tauAT);
+    
     C       = 10.4*(roL/roF);
     alfa1  = -(1 + etaL/roL)*C;     //Auxiliary functions from Pablo
     alfa2  = -(1 + etaF/roF);       //Auxiliary functions from Pablo
-    rmrbw  = 9.99;        //Linear regression coefficient for rmr estimation
-    rmrage = 4.92;        //Linear regression coefficient for rmr estimation
-    rmrht  = 625.0;       //Linear regression coefficient for rmr estimation
-    rmr_m  = 5.0;         //Linear regression coefficient for rmr estimation (men)
-    rmr_f  = 161.0;       //Linear regression coefficient for rmr estimation (women)
     G_base = NumericVector(nind, 0.5);
 }
 
+//Constant replaced by its value in parameters (if given)
+void Adult::parameter(const char* name, double& value){
+    if (parameters.containsElementNamed(name)){
+        value = as<double>(parameters[name]);
+    }
+}
+
 //Estimation of Resting Metabolic Rate (rmr) in kcal
 void Adult::getRMR(void){
-    //These equations come from Miffin & St.Jeor
-    //Recall that sex = 0 => "male" and sex = 1 => "female"
-    rmr = (rmrbw*bw + rmrht*ht - rmrage*age + rmr_m)*(1-sex) +
-    (rmrbw*bw + rmrht*ht - rmrage*age - rmr_f)*sex;
+    //Equation of each individual (Miffin & St.Jeor by default)
+    rmr = RMR(bw, age);
+}
+
+//Resting Metabolic Rate for weight and age with the equation of each individual.
+//Each policy runs over its individuals (see energy_equations.h)
+NumericVector Adult::RMR(NumericVector weight, NumericVector age_t){
+    NumericVector value(nind);
+    rmrPolicy<MifflinStJeor>(RMR_MIFFLIN, weight, age_t, value);
+    rmrPolicy<HarrisBenedict>(RMR_HARRIS_BENEDICT, weight, age_t, value);
+    rmrPolicy<Schofield>(RMR_SCHOFIELD, weight, age_t, value);
+    rmrPolicy<Henry>(RMR_HENRY, weight, age_t, value);
+    return value;
+}
+
+template <class Policy>
+void Adult::rmrPolicy(int equation, NumericVector weight, NumericVector age_t, NumericVector value){
+    for (int i = 0; i < nind; i++){
+        if (rmrEquation(i) == equation){
+            value(i) = Policy::rmr(weight(i), ht(i), age_t(i), sex(i));
+        }
+    }
 }
 
 //Estimation of calories at baseline
 void Adult::getCaloricSteadyState(void){
     //These estimation assumes Energy Intake = Energy Expenditure.
     //Energy is returned in kcal
-    steadystate = rmr*PAL(0,_);  //Check when running for the first tiem it might me PAL(_,0)
+    steadystate = rmr*deltaPAL(0.0);  //Check when running for the first tiem it might me PAL(_,0)
 }
 
 void Adult::getATinit(void){
@@ -288,14 +355,17 @@ void Adult::getEnergy(void){
 NumericVector Adult::delta_times_bw(double t, NumericVector F, NumericVector L, NumericVector G, NumericVector ECF){
   // delta(t)*BW(t) = ((1 - beta_TEF)*PAL(t) - 1)*RMR(t) = coef*RMR(t)
    NumericVector coef = ((1 - betaTEF)*deltaPAL(t) - 1);
- //On the other hand: RMR = 9.99*BW(t) + 625*ht - 4.92*age(t) + 5 -166*sex;
-  NumericVector rmr_t = 9.99*(F + L + 3.7*G + ECF) + 625*ht - 4.92*(age+ t/365) +5 -166*sex;
+ //On the other hand: RMR = 9.99*BW(t) + 625*ht - 4.92*age(t) + 5 -166*sex (Mifflin);
+  NumericVector rmr_t = RMR(F + L + 3.7*G + ECF, age + t/365);
    return delta =  coef*rmr_t;   
 }
 
 //Get extracellular water by Silva's equation
 void Adult::getECFinit(void){
-    ecfinit = (0.025*age + 9.57*ht + 0.191*bw - 12.4)*(1.0-sex) + (-4.0 + 5.98*ht + 0.167*bw)*sex;
+    ecfinit = NumericVector(nind);
+    for (int i = 0; i < nind; i++){
+        ecfinit(i) = Silva::ecf(bw(i), ht(i), age(i), sex(i));
+    }
 }
 
 
@@ -346,6 +416,7 @@ NumericVector Adult::CI(double t){
 
 //Total energy intake
 NumericVector Adult::TotalIntake (double t){
+    PerfScope scope(perf.get(), "Intake");
     return EI + deltaEI(t);
 }
 
@@ -358,7 +429,7 @@ void Adult::getK(){
      RMR is from the Mifflin-St Jeor equation. The physical activity pa- rameter, delta, at the baseline
      steady state is determined by equation 8 and therefore you can solve for K.
      */
-    K = (rmr * PAL(0,_)) - gammaL * lean - gammaF * fat - ((1.0 - betaTEF)*PAL(0,_) - 1.0)*rmr/bw * bw; //AQUI! Check when running for the first tiem it might me PAL(_,0)
+    K = (rmr * deltaPAL(0.0)) - gammaL * lean - gammaF * fat - ((1.0 - betaTEF)*deltaPAL(0.0) - 1.0)*rmr/bw * bw; //AQUI! Check when running for the first tiem it might me PAL(_,0)
 }
 
 //Get fat mass as function of lean tissue
@@ -381,8 +452,16 @@ NumericVector Adult::R(double t, NumericVector L, NumericVector G,
     return (R3 + gammaL*L + gammaF*F)/(alfa1 + alfa2*F);
 }
 
+//Names of the BMI categories
+static const char* BMI_LEVELS[] = {"Underweight", "Normal", "Pre-Obese", "Obese", "Unknown"};
+
+static std::vector<std::string> bmiLevels(void){
+    return std::vector<std::string>(BMI_LEVELS, BMI_LEVELS + 5);
+}
+
 //Classifier for bMI
 StringVector Adult::BMIClassifier(NumericVector BMI){
+    PerfScope scope(perf.get(), "BMI categories");
     StringVector classification(BMI.size());
     /*for(int i = 0; i < BMI.size(); i++){
         classification(i) = "Unknown";
@@ -404,155 +483,830 @@ StringVector Adult::BMIClassifier(NumericVector BMI){
             classification(i) = "Obese class III";
         }
     }*/
+    IntegerVector code = BMICode(BMI);
     for(int i = 0; i < BMI.size(); i++){
-        classification(i) = "Unknown";
+        classification(i) = BMI_LEVELS[code(i)];
+    }
+    return classification;
+}
+
+//Stores the BMI category of a step as a column of CAT or in its runs
+void Adult::recordCategory(TrajectoryRecorder& recorder, StringMatrix CAT, CategoryRuns& runs,
+                           bool rle, int step, NumericVector BMI){
+    if (!rle){
+        recorder.record(CAT, "BMI_Category", step, BMIClassifier(BMI));
+        return;
+    }
+    runs.record(step, BMICode(BMI));
+    if (recorder.sampled()){
+        recorder.aggregate("BMI_Category", step, BMIClassifier(BMI));
+    }
+}
+
+//Code of the BMI category (position in BMI_LEVELS)
+IntegerVector Adult::BMICode(NumericVector BMI){
+    IntegerVector code(BMI.size());
+    for(int i = 0; i < BMI.size(); i++){
+        code(i) = 4;
         if (BMI(i) < 18.5){
-            classification(i) = "Underweight";
+            code(i) = 0;
         } else if (BMI(i) >= 18.5 && BMI(i) < 25){
-            classification(i) = "Normal";
+            code(i) = 1;
         } else if (BMI(i) >= 25 && BMI(i) < 30){
-            classification(i) = "Pre-Obese";
+            code(i) = 2;
         } else if (BMI(i) >= 30){
-            classification(i) = "Obese";
+            code(i) = 3;
         }
     }
-    return classification;
+    return code;
 }
 
 
 //Rungue Kutta 4 method for Adult
-List Adult::rk4(double days){
+List Adult::rk4(double days, List control){
     
     //Initial TIME(i-1)
     NumericVector k1, k2, k3, k4;
     
     //Estimate number of elements to loop into
-    const int nsims = std::min(ceil(days/dt), EIchange.nrow() - 1.0);
+    const int nsims = steps(days);
     
-    NumericMatrix AT(nind, nsims + 1); //in rcpp
-    NumericMatrix ECF(nind, nsims + 1); //in rcpp
-    NumericMatrix GLY(nind, nsims + 1); //in rcpp
-    NumericMatrix L(nind, nsims + 1); //in rcpp
-    NumericMatrix F(nind, nsims + 1); //in rcpp
-    NumericMatrix BW(nind, nsims + 1); //in rcpp
-    NumericMatrix BMI(nind, nsims + 1); //in rcpp
-    NumericMatrix TEI(nind, nsims + 1); //in rcpp
-    NumericMatrix AGE(nind, nsims + 1); //in rcpp
-    StringMatrix CAT(nind, nsims + 1); //in rcpp
+    //Trajectories of all individuals or of the sample in control$retain
+    //(see trajectory_recorder.h). Matrices of control$output are overwritten
+    //(see outputMatrix in control.h)
+    TrajectoryRecorder recorder(nind, nsims, control);
+    NumericMatrix AT  = recorder.matrix<NumericMatrix>(control, "Adaptive_Thermogenesis");
+    NumericMatrix ECF = recorder.matrix<NumericMatrix>(control, "Extracellular_Fluid");
+    NumericMatrix GLY = recorder.matrix<NumericMatrix>(control, "Glycogen");
+    NumericMatrix L   = recorder.matrix<NumericMatrix>(control, "Lean_Mass");
+    NumericMatrix F   = recorder.matrix<NumericMatrix>(control, "Fat_Mass");
+    NumericMatrix BW  = recorder.matrix<NumericMatrix>(control, "Body_Weight");
+    NumericMatrix BMI = recorder.matrix<NumericMatrix>(control, "Body_Mass_Index");
+    NumericMatrix TEI = recorder.matrix<NumericMatrix>(control, "Energy_Intake");
+    NumericMatrix AGE = recorder.matrix<NumericMatrix>(control, "Age");
+    NumericVector TIME = outputVector<NumericVector>(control, "Time", nsims + 1);
     
-    NumericVector TIME(nsims + 1); //in rcpp
+    //BMI categories as a matrix or as runs (see category_runs.h)
+    const bool rle   = encodeCategories(control);
+    StringMatrix CAT = rle ? StringMatrix(0, 0) : recorder.matrix<StringMatrix>(control, "BMI_Category");
+    CategoryRuns runs(recorder.individuals(), bmiLevels());
+    
+    //Current states of all individuals
+    NumericVector at    = clone(atinit);
+    NumericVector ecf   = clone(ecfinit);
+    NumericVector gly   = clone(G_base);
+    NumericVector l     = clone(lean);
+    NumericVector age_t = clone(age);
+    NumericVector bmi   = bw/pow(ht,2.0);
+    NumericVector at1, ecf1, gly1, l1, f;
+    AdultStates start;
+    
+    //Energy balance residual of each step from the derivatives at its start
+    //(the first stages) as the model runs (see energy_residual.h)
+    std::shared_ptr<EnergyResidual> residual;
+    if (control.containsElementNamed("residual_tol")){
+        residual = std::make_shared<EnergyResidual>(nsims, dt, controlValue(control, "residual_tol", 1.0), 4);
+    }
     
     //Create initial states in rcpp
-    AT(_,0)  = atinit;
-    ECF(_,0) = ecfinit;
-    GLY(_,0) = G_base;
-    L(_,0)   = lean;
-    F(_,0)   = fatMass(lean);
-    BW(_,0)  = bw;
-    BMI(_,0) = bw/pow(ht,2.0);
-    CAT(_,0) = BMIClassifier(BMI(_,0));
-    TEI(_,0) = EI;
     TIME(0)  = 0.0;
-    AGE(_,0) = age;
+    recorder.record(AT, "Adaptive_Thermogenesis", 0, at);
+    recorder.record(ECF, "Extracellular_Fluid", 0, ecf);
+    recorder.record(GLY, "Glycogen", 0, gly);
+    recorder.record(L, "Lean_Mass", 0, l);
+    recorder.record(F, "Fat_Mass", 0, fatMass(l));
+    recorder.record(BW, "Body_Weight", 0, bw);
+    recorder.record(BMI, "Body_Mass_Index", 0, bmi);
+    recordCategory(recorder, CAT, runs, rle, 0, bmi);
+    recorder.record(TEI, "Energy_Intake", 0, EI);
+    recorder.record(AGE, "Age", 0, age_t);
     
     
     //Loop through all other states
     bool correctVals = true;
     for (int i = 1; i <= nsims; i++){
         
+        //Phases measured with control$perf (see perf_counters.h)
+        PerfScope derivatives(perf.get(), "Derivatives");
         
         //Adaptive thermogenesis
-        k1 = dAT(TIME(i-1), AT(_, i-1)); // f(t_n , y_n)
-        k2 = dAT(TIME(i-1) + 0.5 * dt, AT(_, i-1) + 0.5 * dt * k1); // f(t_n + h/2, y_n + h/2 k1)
-        k3 = dAT(TIME(i-1) + 0.5 * dt, AT(_, i-1) + 0.5 * dt * k2); // f(t_n + h/2, y_n + h/2 k2)
-        k4 = dAT(TIME(i-1) + dt, AT(_, i-1) + dt * k3); // f(t_n + h, y_n + h k3)
+        k1 = dAT(TIME(i-1), at); // f(t_n , y_n)
+        start.AT = k1;
+        k2 = dAT(TIME(i-1) + 0.5 * dt, at + 0.5 * dt * k1); // f(t_n + h/2, y_n + h/2 k1)
+        k3 = dAT(TIME(i-1) + 0.5 * dt, at + 0.5 * dt * k2); // f(t_n + h/2, y_n + h/2 k2)
+        k4 = dAT(TIME(i-1) + dt, at + dt * k3); // f(t_n + h, y_n + h k3)
         
         //Update AT
-        AT(_,i) = AT(_, i-1) + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+        at1 = at + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
         
         //Extracellular fluid
-        k1 = dECF(TIME(i-1), ECF(_, i-1)); // f(t_n , y_n)
-        k2 = dECF(TIME(i-1) + 0.5 * dt, ECF(_, i-1) + 0.5 * dt * k1); // f(t_n + h/2, y_n + h/2 k1)
-        k3 = dECF(TIME(i-1) + 0.5 * dt, ECF(_, i-1) + 0.5 * dt * k2); // f(t_n + h/2, y_n + h/2 k2)
-        k4 = dECF(TIME(i-1) + dt, ECF(_, i-1) + dt * k3); // f(t_n + h, y_n + h k3)
+        k1 = dECF(TIME(i-1), ecf); // f(t_n , y_n)
+        start.ECF = k1;
+        k2 = dECF(TIME(i-1) + 0.5 * dt, ecf + 0.5 * dt * k1); // f(t_n + h/2, y_n + h/2 k1)
+        k3 = dECF(TIME(i-1) + 0.5 * dt, ecf + 0.5 * dt * k2); // f(t_n + h/2, y_n + h/2 k2)
+        k4 = dECF(TIME(i-1) + dt, ecf + dt * k3); // f(t_n + h, y_n + h k3)
         
         //Update ECF
-        ECF(_,i) = ECF(_, i-1) + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+        ecf1 = ecf + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
         
         //Glycogen
-        k1 = dG(TIME(i-1), GLY(_, i-1));
-        k2 = dG(TIME(i-1) + 0.5 * dt, GLY(_, i-1) + 0.5 * dt * k1);
-        k3 = dG(TIME(i-1) + 0.5 * dt, GLY(_, i-1) + 0.5 * dt * k2);
-        k4 = dG(TIME(i-1) + dt, GLY(_, i-1) + dt * k3);
+        k1 = dG(TIME(i-1), gly);
+        start.G = k1;
+        k2 = dG(TIME(i-1) + 0.5 * dt, gly + 0.5 * dt * k1);
+        k3 = dG(TIME(i-1) + 0.5 * dt, gly + 0.5 * dt * k2);
+        k4 = dG(TIME(i-1) + dt, gly + dt * k3);
         
         //Update Glycogen
-        GLY(_,i) = GLY(_, i-1) + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+        gly1 = gly + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
         
         //Lean Mass
-        k1 = dL(TIME(i-1) , L(_, i-1), GLY(_, i-1), AT(_, i-1), ECF(_, i-1));
-        k2 = dL(TIME(i-1) + 0.5 * dt, L(_, i-1) + 0.5 * dt * k1, 0.5*(GLY(_, i) + GLY(_, i-1)),
-                0.5*(AT(_,i) + AT(_, i-1)), 0.5*(ECF(_,i) +ECF(_,i-1)));
-        k3 = dL(TIME(i-1) + 0.5 * dt, L(_, i-1) + 0.5 * dt * k2, 0.5*(GLY(_,i) + GLY(_, i-1)),
-                0.5*(AT(_,i) + AT(_, i-1)), 0.5*(ECF(_,i) + ECF(_,i-1)));
-        k4 = dL(TIME(i-1) + dt, L(_, i-1) + dt*k3, GLY(_,i), AT(_,i), ECF(_,i));
+        k1 = dL(TIME(i-1) , l, gly, at, ecf);
+        start.L = k1;
+        k2 = dL(TIME(i-1) + 0.5 * dt, l + 0.5 * dt * k1, 0.5*(gly1 + gly),
+                0.5*(at1 + at), 0.5*(ecf1 + ecf));
+        k3 = dL(TIME(i-1) + 0.5 * dt, l + 0.5 * dt * k2, 0.5*(gly1 + gly),
+                0.5*(at1 + at), 0.5*(ecf1 + ecf));
+        k4 = dL(TIME(i-1) + dt, l + dt*k3, gly1, at1, ecf1);
         
         //Update L
-        L(_,i) = L(_, i-1) + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+        l1 = l + dt * (k1 + 2.0*k2 + 2.0*k3 + k4)/6.0;
+        derivatives.stop();
         
-        //Update F
-        F(_,i) = fatMass(L(_,i));
+        if (residual.get() != NULL){
+            PerfScope balance(perf.get(), "Energy balance");
+            AdultStates y0 = {at, ecf, gly, l}, y1 = {at1, ecf1, gly1, l1};
+            addResidual(*residual, i, TIME(i-1), y0, start, y1);
+        }
         
-        //Update bw
-        BW(_,i) = F(_,i) + L(_,i) + ECF(_,i) + 3.7*GLY(_,i);
+        l   = l1;
+        at  = at1;
+        ecf = ecf1;
+        gly = gly1;
         
-        //Update BMI
-        BMI(_,i) = BW(_,i)/pow(ht,2.0);
+        //Update F
+        PerfScope composition(perf.get(), "Body composition");
+        f = fatMass(l);
         
-        //Classify BMI
-        CAT(_,i) = BMIClassifier(BMI(_,i));
+        //Update bw and BMI
+        NumericVector bw_t = f + l + ecf + 3.7*gly;
+        bmi = bw_t/pow(ht,2.0);
+        composition.stop();
         
         //Update TIME(i-1)
         TIME(i) = TIME(i-1) + dt;
         
         //Update age
-        AGE(_,i) = AGE(_,i-1) + dt/365.0;
+        age_t = age_t + dt/365.0;
+        
+        PerfScope recording(perf.get(), "Recording");
+        recorder.record(AT, "Adaptive_Thermogenesis", i, at);
+        recorder.record(ECF, "Extracellular_Fluid", i, ecf);
+        recorder.record(GLY, "Glycogen", i, gly);
+        recorder.record(L, "Lean_Mass", i, l);
+        recorder.record(F, "Fat_Mass", i, f);
+        recorder.record(BW, "Body_Weight", i, bw_t);
+        recorder.record(BMI, "Body_Mass_Index", i, bmi);
+        recordCategory(recorder, CAT, runs, rle, i, bmi);
+        recorder.record(AGE, "Age", i, age_t);
         
         //Get energy intake
-        TEI(_,i) = TotalIntake(TIME(i));
+        recorder.record(TEI, "Energy_Intake", i, TotalIntake(TIME(i)));
         
     }
     
+    List result = List::create(Named("Time") = TIME,
+                               Named("Age") = AGE,
+                               Named("Adaptive_Thermogenesis") = AT,
+                               Named("Extracellular_Fluid") = ECF,
+                               Named("Glycogen") = GLY,
+                               Named("Fat_Mass") = F,
+                               Named("Lean_Mass")   = L,
+                               Named("Body_Weight") = BW,
+                               Named("Body_Mass_Index") = BMI,
+                               Named("BMI_Category") = CAT,
+                               Named("Energy_Intake") = TEI,
+                               Named("Correct_Values")=correctVals,
+                               Named("Model_Type")="Adult");
+    
+    if (rle){
+        result["BMI_Category"] = runs.list(nsims + 1);
+    }
+    
+    if (recorder.sampled()){
+        result.push_back(recorder.retained(), "Retained");
+        result.push_back(recorder.aggregates(TIME), "Aggregates");
+    }
+    
+    if (recorder.regressing()){
+        result.push_back(recorder.regressions(TIME), "Regressions");
+    }
+    
+    if (recorder.assessing()){
+        result.push_back(recorder.risks(TIME), "Risk");
+    }
+    
+    if (residual.get() != NULL){
+        result.push_back(residual->list(), "Energy_Residual");
+    }
+    
+    return result;
+    
+}
+
+
+
+//Choose the integration method
+List Adult::integrate(double days, std::string method, List control){
+    
+    //Time and hardware counters of the phases (see perf_counters.h)
+    if (controlValue(control, "perf", 0) != 0){
+        perf = std::make_shared<PerfProfile>();
+    }
+    
+    //Intake change interpolated at the stage times (see energy_source.h)
+    if (control.containsElementNamed("energy_source")){
+        List source = control["energy_source"];
+        EIsource = energySource(as<NumericMatrix>(source["energy"]),
+                                as<NumericVector>(source["time"]),
+                                as<std::string>(source["interpolation"]));
+    }
+    
+    //Order of the method for the recommended dt of the energy balance check
+    //(0 when its error is not set by dt alone: QSS, Multirate and Parareal)
+    List result;
+    int order = 4;
+    const LowStorageScheme* scheme = lowStorageScheme(method);
+    if (method.compare("Parareal") == 0){
+        result = parareal(days, control);
+        order  = 0;
+    } else if (scheme != NULL){
+        result = lowStorage(days, *scheme, control);
+        order  = scheme->order;
+    } else if (method.compare("Multirate") == 0){
+        result = multirate(days, control);
+        order  = 0;
+    } else if (method.compare("Exponential") == 0){
+        result = exponential(days, control);
+    } else if (method.compare("QSS") == 0){
+        result = quasiSteady(days, control);
+        order  = 0;
+    } else if (controlString(control, "variant", "Vector") == "Kernel" &&
+               !control.containsElementNamed("retain") &&
+               !control.containsElementNamed("regression") &&
+               !control.containsElementNamed("risk") &&
+               !control.containsElementNamed("monitor") &&
+               !control.containsElementNamed("residual_tol")){
+        result = rk4Kernel(days, control);
+    } else {
+        result = rk4(days, control);
+    }
+    
+    //Energy balance check of the methods that do not add it as they step
+    if (control.containsElementNamed("residual_tol") && !result.containsElementNamed("Energy_Residual")){
+        result.push_back(energyResidual(result, controlValue(control, "residual_tol", 1.0), order),
+                         "Energy_Residual");
+    }
+    
+    if (perf.get() != NULL){
+        result.push_back(perf->report(), "Performance");
+        perf.reset();
+    }
+    
+    return result;
+}
+
+//Rate of change of the energy stored in the body (kcal/day) from the
+//derivatives of lean mass and glycogen:
+//d/dt (roL*L + roF*F + roG*G) = intake - expenditure
+NumericVector Adult::energyRate(NumericVector L, NumericVector dLdt, NumericVector dGdt){
+    NumericVector dFdt = fatMass(L)*(roL/(roF*C))*dLdt;
+    return roL*dLdt + roF*dFdt + roG*dGdt;
+}
+
+//Derivatives of the states of all individuals at t
+AdultStates Adult::derivatives(double t, const AdultStates& y){
+    AdultStates f = {dAT(t, y.AT), dECF(t, y.ECF), dG(t, y.G), dL(t, y.L, y.G, y.AT, y.ECF)};
+    return f;
+}
+
+//Energy balance residual of the step from y0 at t (with derivatives f0) to
+//y1. The change in stored energy roL*L + roF*F + roG*G is compared against
+//the integral of intake minus expenditure over the step (Simpson's rule with
+//the midpoint state taken from the cubic Hermite interpolant of the step).
+//Inputs are constant within a step so its end is evaluated just inside it.
+void Adult::addResidual(EnergyResidual& residual, int i, double t, const AdultStates& y0,
+                        const AdultStates& f0, const AdultStates& y1){
+    
+    const double tm = t + 0.5*dt;
+    AdultStates f1  = derivatives(t + dt - 1.e-6*dt, y1);
+    
+    //Hermite midpoint: y(t + h/2) = (y0 + y1)/2 + h*(f0 - f1)/8
+    AdultStates m;
+    m.AT  = 0.5*(y0.AT + y1.AT) + 0.125*dt*(f0.AT - f1.AT);
+    m.ECF = 0.5*(y0.ECF + y1.ECF) + 0.125*dt*(f0.ECF - f1.ECF);
+    m.G   = 0.5*(y0.G + y1.G) + 0.125*dt*(f0.G - f1.G);
+    m.L   = 0.5*(y0.L + y1.L) + 0.125*dt*(f0.L - f1.L);
+    
+    //Simpson's rule for intake - expenditure
+    NumericVector balance = dt*(energyRate(y0.L, f0.L, f0.G) +
+                                4.0*energyRate(m.L, dL(tm, m.L, m.G, m.AT, m.ECF), dG(tm, m.G)) +
+                                energyRate(y1.L, f1.L, f1.G))/6.0;
+    
+    //Change in stored energy
+    NumericVector stored = roL*(y1.L - y0.L) + roF*(fatMass(y1.L) - fatMass(y0.L)) +
+                           roG*(y1.G - y0.G);
+    
+    residual.add(i, stored, balance);
+}
+
+//Energy balance residual of the integrated trajectories for the methods
+//that step each individual on its own (AdultKernel) and do not give their
+//stages back, so the derivatives at the start of each step are evaluated
+//again. rk4 adds the residual of each step as it runs instead.
+List Adult::energyResidual(List model, double tol, int order){
+    
+    NumericVector TIME = model["Time"];
+    NumericMatrix AT   = model["Adaptive_Thermogenesis"];
+    NumericMatrix ECF  = model["Extracellular_Fluid"];
+    NumericMatrix GLY  = model["Glycogen"];
+    NumericMatrix L    = model["Lean_Mass"];
+    
+    const int nsims = TIME.size() - 1;
+    EnergyResidual residual(nsims, dt, tol, order);
+    
+    for (int i = 1; i <= nsims; i++){
+        AdultStates y0 = {AT(_,i-1), ECF(_,i-1), GLY(_,i-1), L(_,i-1)};
+        AdultStates y1 = {AT(_,i), ECF(_,i), GLY(_,i), L(_,i)};
+        addResidual(residual, i, TIME(i-1), y0, derivatives(TIME(i-1) + 1.e-6*dt, y0), y1);
+    }
+    
+    return residual.list();
+}
+
+//Scalar version of the model for individual i
+AdultKernel Adult::kernel(int i){
+    
+    AdultParameters p;
+    p.ht      = ht(i);
+    p.age     = age(i);
+    p.sex     = sex(i);
+    p.EI      = EI(i);
+    p.K       = K(i);
+    p.kG      = kG(i);
+    p.CIb     = CIb(i);
+    p.pcarb   = pcarb(i);
+    p.ecfinit = ecfinit(i);
+    p.fat     = fat(i);
+    p.lean    = lean(i);
+    p.rmr     = rmrEquation(i);
+    p.roG     = roG;
+    p.Na      = Na;
+    p.zetaNa  = zetaNa;
+    p.zetaCI  = zetaCI;
+    p.roF     = roF;
+    p.roL     = roL;
+    p.gammaF  = gammaF;
+    p.gammaL  = gammaL;
+    p.betaTEF = betaTEF;
+    p.betaAT  = betaAT;
+    p.tauAT   = tauAT;
+    p.C       = C;
+    p.alfa1   = alfa1;
+    p.alfa2   = alfa2;
+    
+    //Each row of the input matrices is an individual
+    AdultInputs in;
+    in.EIchange = EIchange.begin() + column(i);
+    in.NAchange = NAchange.begin() + column(i);
+    in.PAL      = PAL.begin() + column(i);
+    in.nrow     = NAchange.ncol();
+    in.stride   = NAchange.nrow();
+    in.dt       = dt;
+    in.EIsource = EIsource.get();
+    in.column   = column(i);
+    
+    return AdultKernel(p, in);
+}
+
+//Integrates each individual with step(kernel, t, y) which advances its
+//state y from t to t + dt. Individuals are taken in blocks of control$block
+//that advance together one step at a time (so each column of the results is
+//written in runs) and the blocks are shared by control$threads threads (see
+//thread_governor.h). Results do not depend on the block or the threads.
+template <class Step>
+List Adult::stepEach(double days, List control, Step step){
+    
+    const int nsims = steps(days);
+    
+    NumericMatrix AT   = outputMatrix<NumericMatrix>(control, "Adaptive_Thermogenesis", nind, nsims + 1);
+    NumericMatrix ECF  = outputMatrix<NumericMatrix>(control, "Extracellular_Fluid", nind, nsims + 1);
+    NumericMatrix GLY  = outputMatrix<NumericMatrix>(control, "Glycogen", nind, nsims + 1);
+    NumericMatrix L    = outputMatrix<NumericMatrix>(control, "Lean_Mass", nind, nsims + 1);
+    NumericVector TIME = outputVector<NumericVector>(control, "Time", nsims + 1);
+    
+    for (int i = 0; i <= nsims; i++){
+        TIME(i) = i*dt;
+    }
+    
+    //Kernels and initial states are read from R before the threads start
+    std::vector<AdultKernel> people;
+    people.reserve(nind);
+    for (int j = 0; j < nind; j++){
+        people.push_back(kernel(j));
+        AT(j,0) = atinit(j); ECF(j,0) = ecfinit(j); GLY(j,0) = G_base(j); L(j,0) = lean(j);
+    }
+    
+    const int block    = std::max(1.0, controlValue(control, "block", 16));
+    const int nblocks  = (nind + block - 1)/block;
+    const int nthreads = threadBudget(std::max(0.0, controlValue(control, "threads", 0)));
+    
+    double* at  = AT.begin();
+    double* ecf = ECF.begin();
+    double* gly = GLY.begin();
+    double* l   = L.begin();
+    const double* time = TIME.begin();
+    const std::size_t rows = nind;
+    
+    parallelFor(nblocks, nthreads, [&](int b){
+        
+        const int first = b*block;
+        const int last  = std::min(nind, first + block);
+        
+        std::vector<AdultState> y(last - first);
+        for (int j = first; j < last; j++){
+            y[j - first].AT  = at[j];
+            y[j - first].ECF = ecf[j];
+            y[j - first].G   = gly[j];
+            y[j - first].L   = l[j];
+        }
+        
+        PerfScope scope(perf.get(), "Kernel steps");
+        for (int i = 1; i <= nsims; i++){
+            const std::size_t col = i*rows;
+            for (int j = first; j < last; j++){
+                AdultState& s = y[j - first];
+                step(people[j], time[i-1], s);
+                at[col + j] = s.AT; ecf[col + j] = s.ECF; gly[col + j] = s.G; l[col + j] = s.L;
+            }
+        }
+    });
+    
+    return output(TIME, AT, ECF, GLY, L, true, control);
+}
+
+//Runge Kutta 4 of each individual (AdultKernel::rk4Step) instead of the
+//whole population at once as in rk4: same steps, agreeing up to rounding,
+//without the k1..k4 vectors of the population (control$variant = "Kernel")
+List Adult::rk4Kernel(double days, List control){
+    const double h = dt;
+    return stepEach(days, control, [h](const AdultKernel& person, double t, AdultState& y){
+        person.rk4Step(t, h, y);
+    });
+}
+
+//Low-storage Runge Kutta (see low_storage_rk.h). Each individual is integrated
+//with AdultKernel::lowStorageStep so that the scratch memory is two registers
+//per state of one individual instead of the k1..k4 vectors of the population.
+List Adult::lowStorage(double days, const LowStorageScheme& scheme, List control){
+    const double h = dt;
+    return stepEach(days, control, [&scheme, h](const AdultKernel& person, double t, AdultState& y){
+        person.lowStorageStep(t, h, scheme, y);
+    });
+}
+
+//Multirate integration (see AdultKernel::multirateStep): lean mass and AT
+//take steps of control$macro_dt days and ECF and glycogen substeps of dt.
+//Results are given every dt as in rk4.
+List Adult::multirate(double days, List control){
+    
+    const int nsims = steps(days);
+    const int m     = std::max(1.0, round(controlValue(control, "macro_dt", 7.0)/dt));
+    
+    NumericMatrix AT   = outputMatrix<NumericMatrix>(control, "Adaptive_Thermogenesis", nind, nsims + 1);
+    NumericMatrix ECF  = outputMatrix<NumericMatrix>(control, "Extracellular_Fluid", nind, nsims + 1);
+    NumericMatrix GLY  = outputMatrix<NumericMatrix>(control, "Glycogen", nind, nsims + 1);
+    NumericMatrix L    = outputMatrix<NumericMatrix>(control, "Lean_Mass", nind, nsims + 1);
+    NumericVector TIME = outputVector<NumericVector>(control, "Time", nsims + 1);
+    
+    for (int i = 0; i <= nsims; i++){
+        TIME(i) = i*dt;
+    }
+    
+    std::vector<AdultState> states(m + 1);
+    for (int j = 0; j < nind; j++){
+        
+        AdultKernel person = kernel(j);
+        
+        AdultState y;
+        y.AT  = atinit(j);
+        y.ECF = ecfinit(j);
+        y.G   = G_base(j);
+        y.L   = lean(j);
+        
+        AT(j,0) = y.AT; ECF(j,0) = y.ECF; GLY(j,0) = y.G; L(j,0) = y.L;
+        for (int i = 0; i < nsims; i += m){
+            
+            //The last macro step may be shorter
+            const int substeps = std::min(m, nsims - i);
+            person.multirateStep(TIME(i), dt, substeps, y, &states[0]);
+            
+            for (int k = 1; k <= substeps; k++){
+                AT(j,i+k) = states[k].AT; ECF(j,i+k) = states[k].ECF;
+                GLY(j,i+k) = states[k].G; L(j,i+k) = states[k].L;
+            }
+        }
+    }
+    
+    return output(TIME, AT, ECF, GLY, L, true, control);
+}
+
+//Exponential integration (see AdultKernel::exponentialStep). The inputs are
+//constant within each step of size dt so AT, ECF and glycogen are exact and
+//dt is limited only by the accuracy of lean mass.
+List Adult::exponential(double days, List control){
+    const double h = dt;
+    return stepEach(days, control, [h](const AdultKernel& person, double t, AdultState& y){
+        person.exponentialStep(t, h, y);
+    });
+}
+
+//Quasi-steady-state reduction (see AdultKernel::quasiSteadyStep): glycogen and
+//ECF follow their equilibria and only lean mass and AT are integrated.
+List Adult::quasiSteady(double days, List control){
+    const double h = dt;
+    return stepEach(days, control, [h](const AdultKernel& person, double t, AdultState& y){
+        person.quasiSteadyStep(t, h, y);
+    });
+}
+
+//Pull iterator over the same steps as rk4
+AdultStream Adult::stream(double days, int every){
+    
+    const int nsims = steps(days);
+    
+    std::vector<AdultKernel> kernels;
+    std::vector<AdultState>  initial;
+    for (int j = 0; j < nind; j++){
+        AdultState y0;
+        y0.AT  = atinit(j);
+        y0.ECF = ecfinit(j);
+        y0.G   = G_base(j);
+        y0.L   = lean(j);
+        kernels.push_back(kernel(j));
+        initial.push_back(y0);
+    }
+    
+    return AdultStream(kernels, initial, nsims, every);
+}
+
+//Regularized estimation of the intake change from observed weights
+List Adult::estimateIntake(IntegerVector id, NumericVector time, NumericVector weight,
+                           double days, List control){
+    
+    const int nsims = steps(days);
+    
+    InverseOptions options;
+    options.resolution = controlValue(control, "resolution", 7.0);
+    options.lambda     = controlValue(control, "lambda", -1.0);
+    options.sd         = controlValue(control, "sd", -1.0);
+    options.maxiter    = controlValue(control, "maxiter", 20);
+    options.tol        = controlValue(control, "tol", 0.1);
+    options.threads    = threadBudget(controlValue(control, "threads", 0));
+    options.penalty    = "Tikhonov";
+    if (control.containsElementNamed("penalty")){
+        options.penalty = as<std::string>(control["penalty"]);
+    }
+    
+    std::vector<AdultKernel>         kernels;
+    std::vector<AdultState>          initial;
+    std::vector<InverseObservations> observations(nind);
+    for (int j = 0; j < nind; j++){
+        AdultState y0;
+        y0.AT  = atinit(j);
+        y0.ECF = ecfinit(j);
+        y0.G   = G_base(j);
+        y0.L   = lean(j);
+        kernels.push_back(kernel(j));
+        initial.push_back(y0);
+    }
+    
+    //Weights after the last step are not used
+    for (int k = 0; k < weight.size(); k++){
+        int step = round(time(k)/dt);
+        if (step <= nsims){
+            observations[id(k)].step.push_back(step);
+            observations[id(k)].weight.push_back(weight(k));
+        }
+    }
+    
+    std::vector<InverseResult> results;
+    intakeInverse(kernels, initial, observations, nsims, dt, options, results);
+    
+    NumericVector TIME(nsims + 1);
+    NumericMatrix EI(nind, nsims + 1);
+    NumericMatrix LOWER(nind, nsims + 1);
+    NumericMatrix UPPER(nind, nsims + 1);
+    NumericMatrix BW(nind, nsims + 1);
+    NumericVector LAMBDA(nind), SIGMA(nind);
+    IntegerVector ITER(nind);
+    LogicalVector CONVERGED(nind);
+    
+    for (int i = 0; i <= nsims; i++){
+        TIME(i) = i*dt;
+    }
+    
+    for (int j = 0; j < nind; j++){
+        for (int i = 0; i <= nsims; i++){
+            EI(j,i)    = results[j].EIchange[i];
+            if (ISNAN(results[j].sd[i])){
+                LOWER(j,i) = NA_REAL;
+                UPPER(j,i) = NA_REAL;
+            } else {
+                LOWER(j,i) = results[j].EIchange[i] - 1.96*results[j].sd[i];
+                UPPER(j,i) = results[j].EIchange[i] + 1.96*results[j].sd[i];
+            }
+            BW(j,i)    = results[j].BW[i];
+        }
+        LAMBDA(j)    = results[j].lambda;
+        SIGMA(j)     = ISNAN(results[j].sigma) ? NA_REAL : results[j].sigma;
+        ITER(j)      = results[j].iterations;
+        CONVERGED(j) = results[j].converged;
+    }
+    
     return List::create(Named("Time") = TIME,
-                        Named("Age") = AGE,
-                        Named("Adaptive_Thermogenesis") = AT,
-                        Named("Extracellular_Fluid") = ECF,
-                        Named("Glycogen") = GLY,
-                        Named("Fat_Mass") = F,
-                        Named("Lean_Mass")   = L,
+                        Named("Energy_Intake_Change") = EI,
+                        Named("Lower") = LOWER,
+                        Named("Upper") = UPPER,
                         Named("Body_Weight") = BW,
-                        Named("Body_Mass_Index") = BMI,
-                        Named("BMI_Category") = CAT,
-                        Named("Energy_Intake") = TEI,
-                        Named("Correct_Values")=correctVals,
-                        Named("Model_Type")="Adult");
+                        Named("Lambda") = LAMBDA,
+                        Named("Sigma") = SIGMA,
+                        Named("Iterations") = ITER,
+                        Named("Converged") = CONVERGED,
+                        Named("Model_Type") = "Adult_Intake");
+}
+
+//Outputs derived from the trajectories of the states
+List Adult::output(NumericVector TIME, NumericMatrix AT, NumericMatrix ECF,
+                   NumericMatrix GLY, NumericMatrix L, bool correctVals, List control){
+    
+    const int nsims = TIME.size() - 1;
+    
+    NumericMatrix F   = outputMatrix<NumericMatrix>(control, "Fat_Mass", nind, nsims + 1);
+    NumericMatrix BW  = outputMatrix<NumericMatrix>(control, "Body_Weight", nind, nsims + 1);
+    NumericMatrix BMI = outputMatrix<NumericMatrix>(control, "Body_Mass_Index", nind, nsims + 1);
+    NumericMatrix TEI = outputMatrix<NumericMatrix>(control, "Energy_Intake", nind, nsims + 1);
+    NumericMatrix AGE = outputMatrix<NumericMatrix>(control, "Age", nind, nsims + 1);
+    
+    //BMI categories as a matrix or as runs (see category_runs.h)
+    const bool rle   = encodeCategories(control);
+    StringMatrix CAT = rle ? StringMatrix(0, 0) : outputMatrix<StringMatrix>(control, "BMI_Category", nind, nsims + 1);
+    TrajectoryRecorder recorder(nind, nsims, List());
+    CategoryRuns runs(recorder.individuals(), bmiLevels());
+    
+    AGE(_,0) = age;
+    for (int i = 0; i <= nsims; i++){
+        F(_,i)   = fatMass(L(_,i));
+        BW(_,i)  = F(_,i) + L(_,i) + ECF(_,i) + 3.7*GLY(_,i);
+        BMI(_,i) = BW(_,i)/pow(ht,2.0);
+        TEI(_,i) = TotalIntake(TIME(i));
+        if (i > 0){
+            AGE(_,i) = AGE(_,i-1) + dt/365.0;
+        }
+    }
+    
+    //Initial weight is the input weight (as in rk4)
+    BW(_,0)  = bw;
+    BMI(_,0) = bw/pow(ht,2.0);
+    TEI(_,0) = EI;
+    
+    for (int i = 0; i <= nsims; i++){
+        recordCategory(recorder, CAT, runs, rle, i, BMI(_,i));
+    }
+    
+    List result = List::create(Named("Time") = TIME,
+                               Named("Age") = AGE,
+                               Named("Adaptive_Thermogenesis") = AT,
+                               Named("Extracellular_Fluid") = ECF,
+                               Named("Glycogen") = GLY,
+                               Named("Fat_Mass") = F,
+                               Named("Lean_Mass")   = L,
+                               Named("Body_Weight") = BW,
+                               Named("Body_Mass_Index") = BMI,
+                               Named("BMI_Category") = CAT,
+                               Named("Energy_Intake") = TEI,
+                               Named("Correct_Values")=correctVals,
+                               Named("Model_Type")="Adult");
+    
+    if (rle){
+        result["BMI_Category"] = runs.list(nsims + 1);
+    }
     
+    return result;
 }
 
+//Time-parallel (Parareal) integration. Each individual is integrated in
+//parallel over time slices with rk4 as fine propagator; see parareal.cpp.
+List Adult::parareal(double days, List control){
+    
+    //Same number of steps as rk4
+    const int nsims = steps(days);
+    
+    //Options. The slices (and so the result) do not depend on the threads
+    //the process may use (see thread_governor.h).
+    int nthreads = controlValue(control, "threads", std::max(1u, std::thread::hardware_concurrency()));
+    PararealOptions options;
+    options.threads   = threadBudget(std::max(1, nthreads));
+    options.slices    = controlValue(control, "slices", nthreads);
+    options.coarse_dt = controlValue(control, "coarse_dt", 7.0);
+    options.tol       = controlValue(control, "tol", 1.e-8);
+    options.maxiter   = controlValue(control, "maxiter", options.slices);
+    
+    if (nthreads < 1 || options.slices < 1 || options.coarse_dt <= 0){
+        stop("Invalid Parareal control: threads, slices and coarse_dt must be positive.");
+    }
+    
+    NumericMatrix AT   = outputMatrix<NumericMatrix>(control, "Adaptive_Thermogenesis", nind, nsims + 1);
+    NumericMatrix ECF  = outputMatrix<NumericMatrix>(control, "Extracellular_Fluid", nind, nsims + 1);
+    NumericMatrix GLY  = outputMatrix<NumericMatrix>(control, "Glycogen", nind, nsims + 1);
+    NumericMatrix L    = outputMatrix<NumericMatrix>(control, "Lean_Mass", nind, nsims + 1);
+    NumericVector TIME = outputVector<NumericVector>(control, "Time", nsims + 1);
+    IntegerVector ITER(nind);
+    
+    for (int i = 0; i <= nsims; i++){
+        TIME(i) = i*dt;
+    }
+    
+    std::vector<AdultState> trajectory;
+    for (int j = 0; j < nind; j++){
+        
+        AdultState y0;
+        y0.AT  = atinit(j);
+        y0.ECF = ecfinit(j);
+        y0.G   = G_base(j);
+        y0.L   = lean(j);
+        
+        ITER(j) = ::parareal(kernel(j), y0, nsims, dt, options, trajectory);
+        
+        for (int i = 0; i <= nsims; i++){
+            AT(j,i)  = trajectory[i].AT;
+            ECF(j,i) = trajectory[i].ECF;
+            GLY(j,i) = trajectory[i].G;
+            L(j,i)   = trajectory[i].L;
+        }
+    }
+    
+    List result = output(TIME, AT, ECF, GLY, L, true, control);
+    result.push_back(ITER, "Parareal_Iterations");
+    return result;
+}
 
+//Steps integrated: those of the days up to the last column of the inputs.
+//With an energy source EIchange is a placeholder of one column and NAchange
+//(of the same size as PAL) has the steps.
+int Adult::steps(double days){
+    const NumericMatrix& inputs = EIsource ? NAchange : EIchange;
+    return std::min(ceil(days/dt), inputs.ncol() - 1.0);
+}
 
 //Change in calories
 NumericVector Adult::deltaEI(double t){
-    return EIchange(floor(t/dt),_);
+    if (EIsource){
+        NumericVector value(nind);
+        for (int i = 0; i < nind; i++){
+            value(i) = EIsource->value(column(i), t);
+        }
+        return value;
+    }
+    return inputRow(EIchange, t);
 }
 
 //Change in sodiumxs
 NumericVector Adult::deltaNA(double t){
-    return NAchange(floor(t/dt),_);
+    return inputRow(NAchange, t);
 }
 
 
 //Change in sodiumxs
 NumericVector Adult::deltaPAL(double t){
-    return PAL(floor(t/dt),_);
+    return inputRow(PAL, t);
 }  // Check
 
+//Values of an input matrix at time t (its column). In ensembles the
+//individuals share the rows of the inputs (see inputColumn).
+NumericVector Adult::inputRow(NumericMatrix input, double t){
+    NumericVector row = input(_,floor(t/dt));
+    if (inputColumn.size() == 0){
+        return row;
+    }
+    NumericVector value(nind);
+    for (int i = 0; i < nind; i++){
+        value(i) = row(inputColumn(i));
+    }
+    return value;
+}
+
+//Row of the inputs of individual i
+int Adult::column(int i){
+    return inputColumn.size() == 0 ? i : inputColumn(i);
+}
+
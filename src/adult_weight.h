@@ -31,9 +31,28 @@
 #define adult_weight_h
 
 #include <math.h>
+#include <memory>
 #include <Rcpp.h>
+#include "adult_kernel.h"
+#include "energy_equations.h"
+#include "adult_stream.h"
+#include "intake_inverse.h"
+#include "trajectory_recorder.h"
+#include "category_runs.h"
+#include "energy_source_wrapper.h"
+#include "perf_counters.h"
 using namespace Rcpp;
 
+class EnergyResidual;
+
+//States (or their derivatives) of all individuals
+struct AdultStates {
+    NumericVector AT;
+    NumericVector ECF;
+    NumericVector G;
+    NumericVector L;
+};
+
 //Create a Adult class to contain individual parameters
 //--------------------------------------------------------------------------------
 class Adult {
@@ -43,21 +62,27 @@ public:
     Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
           NumericVector sexstring, NumericMatrix input_EIchange,
           NumericMatrix input_NAchange, NumericMatrix physicalactivity,
-          NumericVector percentc, NumericVector percentb, double dt, bool checkValues);
+          NumericVector percentc, NumericVector percentb, double dt, bool checkValues,
+          IntegerVector rmrEquation, IntegerVector inputColumn,
+          List parameters = List());
     
     //Constructor for when initial energy or initial fat intake is added by user
     Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
           NumericVector sexstring, NumericMatrix input_EIchange,
           NumericMatrix input_NAchange, NumericMatrix physicalactivity,
           NumericVector percentc, NumericVector percentb, double dt,
-          NumericVector extradata, bool checkValues, bool isEnergy);
+          NumericVector extradata, bool checkValues, bool isEnergy,
+          IntegerVector rmrEquation, IntegerVector inputColumn,
+          List parameters = List());
     
     //Constructor for when initial energy intake and initial fat is added by user
     Adult(NumericVector weight, NumericVector height, NumericVector age_yrs,
           NumericVector sexstring, NumericMatrix input_EIchange,
           NumericMatrix input_NAchange, NumericMatrix physicalactivity,
           NumericVector percentc, NumericVector percentb, double dt,
-          NumericVector input_EI, NumericVector input_fat, bool checkValues);
+          NumericVector input_EI, NumericVector input_fat, bool checkValues,
+          IntegerVector rmrEquation, IntegerVector inputColumn,
+          List parameters = List());
     
     //Destroyer
     ~ Adult();
@@ -83,11 +108,45 @@ public:
     NumericMatrix EIchange;
     NumericMatrix NAchange;
     
+    //RMR equation of each individual (see energy_equations.h) and row of
+    //the inputs it uses (empty when each individual has its own row; in
+    //ensembles several individuals share the same inputs)
+    IntegerVector rmrEquation;
+    IntegerVector inputColumn;
+    
+    //Intake change interpolated at any time instead of EIchange when the
+    //model is given an energy source (see energy_source.h)
+    std::shared_ptr<EnergySource> EIsource;
+    
+    //Time and hardware counters of the phases with control$perf (see perf_counters.h)
+    std::shared_ptr<PerfProfile> perf;
+    
 
     
     //Functions
     //---------------------------------------------------------------------------
-    List rk4(double days); //in Rcpp:
+    int  steps(double days);
+    List rk4(double days, List control); //in Rcpp:
+    List rk4Kernel(double days, List control);
+    List parareal(double days, List control);
+    List lowStorage(double days, const LowStorageScheme& scheme, List control);
+    List multirate(double days, List control);
+    List exponential(double days, List control);
+    List quasiSteady(double days, List control);
+    List integrate(double days, std::string method, List control);
+    
+    //Scalar version of the model for individual i (see adult_kernel.h)
+    AdultKernel kernel(int i);
+    
+    //Step by step integration without R objects (see adult_stream.h).
+    //The stream uses the inputs of this Adult which must outlive it.
+    AdultStream stream(double days, int every);
+    
+    //Intake change of each individual that best explains the weights observed
+    //at the times given (see intake_inverse.h). id is the individual (from 0)
+    //of each weight.
+    List estimateIntake(IntegerVector id, NumericVector time, NumericVector weight,
+                        double days, List control);
     
 private:
     
@@ -99,8 +158,10 @@ private:
     NumericVector delta;           //Delta parameter of activity
     NumericVector atinit;          //Initial Adaptive Thermogenesis
     
-    //Pre-defined parameters applicable to the whole population
+    //Pre-defined parameters applicable to the whole population. Those named
+    //in parameters (control$parameters) take the value given.
     //---------------------------------------------------------------------------
+    List   parameters;
     double roG;     //1000*17.6*0.23900573614 #Changed from kjoules to kcals
     double Na ;     // (1000*3.22)#Sodium
     double zetaNa;
@@ -117,18 +178,17 @@ private:
     double C;       //10.4*(roL/roF)
     double alfa1;   //Auxiliary functions from Pablo
     double alfa2;   //Auxiliary functions from Pablo
-    double rmrbw;
-    double rmrage;
-    double rmrht;
-    double rmr_m;
-    double rmr_f;
     int    nind; //Number of individuals in model
     double dt;   //Delta t for Rungue Kutta 4
     bool check;
     
     //Auxiliary functions
     void getRMR(void);
+    NumericVector RMR(NumericVector weight, NumericVector age_t);
+    template <class Policy>
+    void rmrPolicy(int equation, NumericVector weight, NumericVector age_t, NumericVector value);
     void getParameters(void);
+    void parameter(const char* name, double& value);
     void getBaselineMass(void);
     void getCaloricSteadyState(void);
     void getEnergy(void);
@@ -140,19 +200,34 @@ private:
     void build(NumericVector weight, NumericVector height, NumericVector age_yrs,
                NumericVector sexstring, NumericMatrix input_EIchange,
                NumericMatrix input_NAchange, NumericMatrix physicalactivity,
-               NumericVector percentc, NumericVector percentb, double dt, bool checkValues);
+               NumericVector percentc, NumericVector percentb, double dt, bool checkValues,
+               IntegerVector rmrEquation, IntegerVector inputColumn);
     void build(NumericVector weight, NumericVector height, NumericVector age_yrs,
                NumericVector sexstring, NumericMatrix input_EIchange,
                NumericMatrix input_NAchange, NumericMatrix physicalactivity,
                NumericVector percentc, NumericVector percentb, double dt, NumericVector extradata,
-               bool checkValues, bool isEnergy);
+               bool checkValues, bool isEnergy, IntegerVector rmrEquation,
+               IntegerVector inputColumn);
     void build(NumericVector weight, NumericVector height, NumericVector age_yrs,
                NumericVector sexstring, NumericMatrix input_EIchange,
                NumericMatrix input_NAchange, NumericMatrix physicalactivity,
                NumericVector percentc, NumericVector percentb, double dt, NumericVector input_EI,
-               NumericVector input_fat,bool checkValues);
+               NumericVector input_fat,bool checkValues, IntegerVector rmrEquation,
+               IntegerVector inputColumn);
     NumericVector TotalIntake (double t);
     StringVector  BMIClassifier(NumericVector BMI);
+    IntegerVector BMICode(NumericVector BMI);
+    void recordCategory(TrajectoryRecorder& recorder, StringMatrix CAT, CategoryRuns& runs,
+                        bool rle, int step, NumericVector BMI);
+    template <class Step>
+    List stepEach(double days, List control, Step step);
+    List output(NumericVector TIME, NumericMatrix AT, NumericMatrix ECF,
+                NumericMatrix GLY, NumericMatrix L, bool correctVals, List control);
+    List energyResidual(List model, double tol, int order);
+    void addResidual(EnergyResidual& residual, int i, double t, const AdultStates& y0,
+                     const AdultStates& f0, const AdultStates& y1);
+    AdultStates derivatives(double t, const AdultStates& y);
+    NumericVector energyRate(NumericVector L, NumericVector dLdt, NumericVector dGdt);
     NumericVector CI(double t);
     NumericVector R(double t, NumericVector L, NumericVector G,
                     NumericVector AT, NumericVector ECF);
@@ -160,6 +235,8 @@ private:
     NumericVector deltaPAL(double t);
     NumericVector deltaEI(double t);
     NumericVector deltaNA(double t);
+    NumericVector inputRow(NumericMatrix input, double t);
+    int column(int i);
     NumericVector delta_times_bw(double t, NumericVector F, NumericVector L, NumericVector G, NumericVector ECF);
     NumericVector TEF(double t);
     NumericVector dAT(double t, NumericVector AT);
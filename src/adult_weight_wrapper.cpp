@@ -10,7 +10,7 @@
 //  ht              .-  Height (m).
 //  age             .-  Years since individual first arrived to Earth.
 //  sex             .-  Either 1 = "female" or 0 = "male".
-//  EIchange        .-  Change in energy intake (kcal).
+//  EIchange        .-  Change in energy intake (kcal); one row per individual and column per step.
 //  NAchange        .-  Change in sodium consumption (mg).
 //  PAL             .-  Physical activity level. (Between 1.4 and 2.4)
 //  pcarb           .-  Proportion of carbohydrates from diet throughout the time the model runs.
@@ -21,6 +21,15 @@
 //  isEnergy        .-  Boolean to determine if energy intake at baseline is given
 //  input_EI        .-  Energy intake (kcal). 
 //  input_fat       .-  Fat Mass (kg) of the individual.
+//  method          .-  Integration method: "RK4", "Parareal", "LSRK3", "LSRK4", "Multirate",
+//                      "Exponential" or "QSS".
+//  control         .-  List of options of the integration method.
+//  rmrEquation     .-  Code of the RMR equation of each individual (see energy_equations.h).
+//  inputColumn     .-  Row of the inputs of each individual (empty if one row each).
+//  id              .-  Individual (from 0) of each observed weight.
+//  time            .-  Day of each observed weight.
+//  weight          .-  Observed weights (kg).
+//  every           .-  Steps between the states read from the stream.
 //
 //  Authors:
 //  Dalia Camacho-García-Formentí
@@ -64,19 +73,22 @@
 
 #include <Rcpp.h>
 #include "adult_weight.h"
+#include "control.h"
 
 // [[Rcpp::export]]
 List adult_weight_wrapper(NumericVector bw, NumericVector ht, NumericVector age,
                           NumericVector sex, NumericMatrix EIchange,
                           NumericMatrix NAchange, NumericMatrix PAL,
                           NumericVector pcarb_base, NumericVector pcarb, double dt,
-                          double days, bool checkValues){
+                          double days, bool checkValues, std::string method, List control,
+                          IntegerVector rmrEquation, IntegerVector inputColumn){
     
     //Create new adult with characteristics
-    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, checkValues);
+    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, checkValues,
+                  rmrEquation, inputColumn, controlList(control, "parameters"));
     
-    //Run model using RK4
-    return Person.rk4(days);
+    //Run model using RK4 or the chosen method
+    return Person.integrate(days, method, control);
     
 }
 
@@ -85,13 +97,16 @@ List adult_weight_wrapper_EI(NumericVector bw, NumericVector ht, NumericVector a
                           NumericVector sex, NumericMatrix EIchange,
                           NumericMatrix NAchange, NumericMatrix PAL,
                           NumericVector pcarb_base, NumericVector pcarb, double dt,
-                             NumericVector extradata, double days, bool checkValues, bool isEnergy){
+                             NumericVector extradata, double days, bool checkValues, bool isEnergy,
+                             std::string method, List control,
+                             IntegerVector rmrEquation, IntegerVector inputColumn){
     
     //Create new adult with characteristics
-    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, extradata, checkValues, isEnergy);
+    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, extradata, checkValues, isEnergy,
+                  rmrEquation, inputColumn, controlList(control, "parameters"));
     
-    //Run model using RK4
-    return Person.rk4(days);
+    //Run model using RK4 or the chosen method
+    return Person.integrate(days, method, control);
     
 }
 
@@ -101,12 +116,68 @@ List adult_weight_wrapper_EI_fat(NumericVector bw, NumericVector ht, NumericVect
                              NumericMatrix NAchange, NumericMatrix PAL,
                              NumericVector pcarb_base, NumericVector pcarb, double dt,
                              NumericVector input_EI, NumericVector input_fat,
-                                 double days, bool checkValues){
+                                 double days, bool checkValues, std::string method, List control,
+                                 IntegerVector rmrEquation, IntegerVector inputColumn){
     
     //Create new adult with characteristics
-    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, input_EI, input_fat, checkValues);
+    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, input_EI, input_fat, checkValues,
+                  rmrEquation, inputColumn, controlList(control, "parameters"));
     
-    //Run model using RK4
-    return Person.rk4(days);
+    //Run model using RK4 or the chosen method
+    return Person.integrate(days, method, control);
+    
+}
+
+// [[Rcpp::export]]
+List adult_intake_wrapper(NumericVector bw, NumericVector ht, NumericVector age,
+                          NumericVector sex, NumericMatrix EIchange,
+                          NumericMatrix NAchange, NumericMatrix PAL,
+                          NumericVector pcarb_base, NumericVector pcarb, double dt,
+                          double days, IntegerVector id, NumericVector time,
+                          NumericVector weight, List control, IntegerVector rmrEquation){
+    
+    //Create new adult with characteristics (EIchange is replaced by the estimate)
+    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, false,
+                  rmrEquation, IntegerVector(), controlList(control, "parameters"));
+    
+    //Intake change explaining the observed weights
+    return Person.estimateIntake(id, time, weight, days, control);
+    
+}
+
+// [[Rcpp::export]]
+List adult_stream_wrapper(NumericVector bw, NumericVector ht, NumericVector age,
+                          NumericVector sex, NumericMatrix EIchange,
+                          NumericMatrix NAchange, NumericMatrix PAL,
+                          NumericVector pcarb_base, NumericVector pcarb, double dt,
+                          double days, int every, IntegerVector rmrEquation){
+    
+    //Create new adult with characteristics
+    Adult Person (bw,  ht, age, sex, EIchange, NAchange, PAL, pcarb,  pcarb_base, dt, false,
+                  rmrEquation, IntegerVector(), List());
+    
+    //Pull the states of the stream (see adult_stream.h)
+    AdultStream stream = Person.stream(days, every);
+    std::vector<double> times, weights, fat;
+    for (AdultStream::iterator it = stream.begin(); it != stream.end(); ++it){
+        times.push_back(it->time());
+        for (int i = 0; i < it->size(); i++){
+            weights.push_back(it->bodyWeight(i));
+            fat.push_back(it->fatMass(i));
+        }
+    }
+    
+    const int nind   = stream.size();
+    const int nsteps = times.size();
+    NumericMatrix BW(nind, nsteps), FM(nind, nsteps);
+    for (int k = 0; k < nsteps; k++){
+        for (int i = 0; i < nind; i++){
+            BW(i, k) = weights[k*nind + i];
+            FM(i, k) = fat[k*nind + i];
+        }
+    }
+    
+    return List::create(Named("Time") = NumericVector(times.begin(), times.end()),
+                        Named("Body_Weight") = BW, Named("Fat_Mass") = FM);
     
 }
@@ -0,0 +1,67 @@
+//
+//  category_runs.cpp
+//
+//  Run-length encoding of categorical trajectories (see category_runs.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include "category_runs.h"
+
+CategoryRuns::CategoryRuns(const std::vector<int>& rows, const std::vector<std::string>& levels) :
+    rows(rows), levels(levels), start(rows.size()), code(rows.size()){
+}
+
+void CategoryRuns::record(int step, IntegerVector value){
+    for (size_t r = 0; r < rows.size(); r++){
+        int c = value(rows[r]);
+        if (code[r].empty() || code[r].back() != c){
+            start[r].push_back(step);
+            code[r].push_back(c);
+        }
+    }
+}
+
+List CategoryRuns::list(int nsteps) const {
+    
+    int nruns = 0;
+    for (size_t r = 0; r < rows.size(); r++){
+        nruns += start[r].size();
+    }
+    
+    IntegerVector INDIVIDUAL(nruns), START(nruns);
+    StringVector  CATEGORY(nruns);
+    int k = 0;
+    for (size_t r = 0; r < rows.size(); r++){
+        for (size_t j = 0; j < start[r].size(); j++, k++){
+            INDIVIDUAL(k) = r + 1;
+            START(k)      = start[r][j];
+            CATEGORY(k)   = levels[code[r][j]];
+        }
+    }
+    
+    return List::create(Named("Individual") = INDIVIDUAL,
+                        Named("Start") = START,
+                        Named("Category") = CATEGORY,
+                        Named("Steps") = nsteps);
+}
@@ -0,0 +1,74 @@
+//
+//  category_runs.h
+//
+//  Run-length encoding of categorical trajectories (e.g. BMI category).
+//  Categories change only a few times over a run so instead of a category
+//  for each individual and step only the steps where the category of an
+//  individual changes are stored: (individual, start step, category).
+//
+//  Example:
+//      CategoryRuns runs(rows, levels);
+//      for (int i = 0; i <= nsims; i++){
+//          runs.record(i, code);    //code(j) indexes levels
+//      }
+//      result.push_back(runs.list(nsims + 1), "BMI_Category");
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef category_runs_h
+#define category_runs_h
+
+#include <vector>
+#include <string>
+#include <Rcpp.h>
+using namespace Rcpp;
+
+class CategoryRuns {
+public:
+    
+    //Runs of the individuals rows (positions in the vectors recorded)
+    CategoryRuns(const std::vector<int>& rows, const std::vector<std::string>& levels);
+    
+    //Adds the categories of step; code has one value per individual
+    void record(int step, IntegerVector code);
+    
+    //List with the Individual (from 1), Start (step from 0) and Category of
+    //each run sorted by individual and start and the number of Steps
+    List list(int nsteps) const;
+    
+private:
+    std::vector<int> rows;
+    std::vector<std::string> levels;
+    std::vector<std::vector<int> > start;   //Start of the runs of each individual
+    std::vector<std::vector<int> > code;    //Category of the runs of each individual
+};
+
+//Whether control asks for run-length encoded categories (control$categories = "RLE")
+inline bool encodeCategories(List control){
+    return control.containsElementNamed("categories") &&
+           as<std::string>(control["categories"]).compare("RLE") == 0;
+}
+
+#endif /* category_runs_h */
@@ -20,6 +20,7 @@
 //  B               .-  Richardson parameter
 //  nu              .-  Richardson parameter
 //  C               .-  Richardson parameter
+//  referenceValues .-  Name of the reference pack of FFM and FM (see reference_pack.h)
 //  Note:
 //  Weight = FFM + FM. No extracellular fluid or glycogen is considered
 //  Please see child_weight.hpp for additional information
@@ -71,10 +72,31 @@
 
 
 #include "child_weight.h"
+#include "control.h"
+#include "trajectory_recorder.h"
+#include "energy_residual.h"
+
+//Keys of the cluster or individual ids of the noise (numbers or strings; see
+//intake_noise_control)
+static std::vector<uint64_t> noiseKeys(List options, const char* name){
+    std::vector<uint64_t> keys;
+    if (is<CharacterVector>(options[name])){
+        CharacterVector ids = options[name];
+        for (int i = 0; i < ids.size(); i++){
+            keys.push_back(noiseKey(as<std::string>(ids[i])));
+        }
+    } else {
+        NumericVector ids = options[name];
+        for (int i = 0; i < ids.size(); i++){
+            keys.push_back(noiseKey(ids[i]));
+        }
+    }
+    return keys;
+}
 
 //Default (classic) constructor for energy matrix
 Child::Child(NumericVector input_age, NumericVector input_sex, NumericVector input_bmiCat, NumericVector input_FFM, NumericVector input_FM, NumericMatrix input_EIntake,
-             double input_dt, bool checkValues, double input_referenceValues){
+             double input_dt, bool checkValues, std::string input_referenceValues){
     age   = input_age;
     sex   = input_sex;
     bmiCat = input_bmiCat;
@@ -91,7 +113,7 @@ Child::Child(NumericVector input_age, NumericVector input_sex, NumericVector inp
 //Constructor which uses Richard's curve with the parameters of https://en.wikipedia.org/wiki/Generalised_logistic_function
 Child::Child(NumericVector input_age, NumericVector input_sex,  NumericVector input_bmiCat, NumericVector input_FFM, NumericVector input_FM, double input_K,
              double input_Q, double input_A, double input_B, double input_nu, double input_C, 
-             double input_dt, bool checkValues, double input_referenceValues){
+             double input_dt, bool checkValues, std::string input_referenceValues){
     age   = input_age;
     sex   = input_sex;
     bmiCat = input_bmiCat;
@@ -116,6 +138,13 @@ Child::~Child(void){
 }
 
 void Child::build(){
+    
+    //Reference tables are shared by all children (see reference_pack.h)
+    reference = findReferencePack(referenceValues);
+    if (!reference){
+        stop("Reference pack '" + referenceValues + "' is not loaded.");
+    }
+    
     getParameters();
 }
 
@@ -157,150 +186,24 @@ NumericVector Child::Delta(NumericVector t){
     return deltamin + (deltamax - deltamin)*(1.0 / (1.0 + pow((t / P),h)));
 }
 
-NumericVector Child::FFMReference(NumericVector t){ 
-  /*  return ffm_beta0 + ffm_beta1*t; */
-NumericVector under = ifelse(bmiCat == 1, 1.0, 0.0);
-NumericVector normales = ifelse(bmiCat == 2, 1.0, 0.0);
-NumericVector over = ifelse(bmiCat == 3, 1.0, 0.0);
-NumericVector obese = ifelse(bmiCat == 4, 1.0, 0.0);
-
-NumericMatrix ffm_ref(17,nind);
-  if(referenceValues == 0){
-  // -------------------------- Mean values
-ffm_ref(0,_)   = 10.134*(1-sex)+9.477*sex;       // 2 years old
-ffm_ref(1,_)   = 12.099*(1 - sex) + 11.494*sex;    // 3 years old
-ffm_ref(2,_)   = 14.0*(1 - sex) + 13.2*sex;        // 4 years old
-ffm_ref(3,_)   = 15.72*(1 - sex) + 14.86*sex;      // 5 years old
-ffm_ref(4,_)   = under*(12.7942*(1-sex) + 13.7957*sex) + normales*(17.0238*(1-sex) + 15.2337*sex) + over*(19.3070*(1-sex) + 17.7866*sex) + obese*(22.2248*(1-sex) + 21.2170*sex);   // 6 years old
-ffm_ref(5,_)   = under*(17.8106*(1-sex) + 18.4835*sex) + normales*(19.0775*(1-sex) + 17.5198*sex) + over*(20.3344*(1-sex) + 18.9406*sex) + obese*(23.1765*(1-sex) + 22.2733*sex);   // 7 years old
-ffm_ref(6,_)   = under*(20.3597*(1-sex) + 18.5363*sex) + normales*(20.4774*(1-sex) + 19.6317*sex) + over*(22.1128*(1-sex) + 21.6080*sex) + obese*(25.8151*(1-sex) + 25.1641*sex);   // 8 years old
-ffm_ref(7,_)   = under*(19.3668*(1-sex) + 17.0314*sex) + normales*(22.3768*(1-sex) + 21.3680*sex) + over*(26.7714*(1-sex) + 26.1791*sex) + obese*(31.3143*(1-sex) + 30.1484*sex);   // 9 years old
-ffm_ref(8,_)   = under*(20.3271*(1-sex) + 23.7546*sex) + normales*(26.2985*(1-sex) + 26.4307*sex) + over*(29.6861*(1-sex) + 32.5531*sex) + obese*(36.6630*(1-sex) + 34.1787*sex);   // 10 years old
-ffm_ref(9,_)   = under*(25.5568*(1-sex) + 21.2704*sex) + normales*(27.4862*(1-sex) + 28.8484*sex) + over*(32.8810*(1-sex) + 34.9192*sex) + obese*(39.1109*(1-sex) + 39.0934*sex);   // 11 years old
-ffm_ref(10,_)   = under*(27.9345*(1-sex) + 27.7570*sex) + normales*(31.5756*(1-sex) + 33.3547*sex) + over*(36.9403*(1-sex) + 39.1253*sex) + obese*(44.0610*(1-sex) + 43.9033*sex);   // 12 years old
-ffm_ref(11,_)   = under*(30.1592*(1-sex) + 26.9376*sex) + normales*(35.7001*(1-sex) + 36.2985*sex) + over*(43.5796*(1-sex) + 41.3549*sex) + obese*(48.3233*(1-sex) + 47.0629*sex);   // 13 years old
-ffm_ref(12,_)   = under*(21.2736*(1-sex) + 29.2222*sex) + normales*(40.4352*(1-sex) + 37.1184*sex) + over*(47.0679*(1-sex) + 44.8448*sex) + obese*(56.7861*(1-sex) + 47.6488*sex);   // 14 years old
-ffm_ref(13,_)   = under*(36.1157*(1-sex) + 34.1242*sex) + normales*(43.2381*(1-sex) + 40.0629*sex) + over*(50.7450*(1-sex) + 45.9011*sex) + obese*(58.3804*(1-sex) + 50.1206*sex);   // 15 years old
-ffm_ref(14,_)   = under*(40.5041*(1-sex) + 38.1473*sex) + normales*(44.8314*(1-sex) + 40.0155*sex) + over*(54.5065*(1-sex) + 44.8730*sex) + obese*(60.6145*(1-sex) + 51.3464*sex);   // 16 years old
-ffm_ref(15,_)   = under*(40.5722*(1-sex) + 36.5821*sex) + normales*(48.7226*(1-sex) + 41.6682*sex) + over*(57.3895*(1-sex) + 48.4993*sex) + obese*(60.3961*(1-sex) + 53.4969*sex);   // 17 years old
-ffm_ref(16,_)   = under*(42.7400*(1-sex) + 31.2639*sex) + normales*(49.7806*(1-sex) + 41.8400*sex) + over*(58.2319*(1-sex) + 47.9007*sex) + obese*(61.8395*(1-sex) + 51.3603*sex);   // 18 years old
-
-  }
-
-
-  if(referenceValues == 1){
-    // -------------------------- Median values
-ffm_ref(0,_)   = 10.134*(1-sex)+9.477*sex;       // 2 years old
-ffm_ref(1,_)   = 12.099*(1 - sex) + 11.494*sex;    // 3 years old
-ffm_ref(2,_)   = 14.0*(1 - sex) + 13.2*sex;        // 4 years old
-ffm_ref(3,_)   = 15.72*(1 - sex) + 14.86*sex;      // 5 years old
-ffm_ref(4,_)   = under*(14.4641*(1-sex) + 13.8627*sex) + normales*(17.1430*(1-sex) + 15.1282*sex) + over*(19.2280*(1-sex) + 17.6859*sex) + obese*(21.9501*(1-sex) + 20.4992*sex);   // 6 years old
-ffm_ref(5,_)   = under*(16.3729*(1-sex) + 16.6347*sex) + normales*(18.2285*(1-sex) + 17.2507*sex) + over*(21.7099*(1-sex) + 20.0341*sex) + obese*(24.9713*(1-sex) + 23.4162*sex);   // 7 years old
-ffm_ref(6,_)   = under*(18.0019*(1-sex) + 17.2583*sex) + normales*(19.9148*(1-sex) + 19.4286*sex) + over*(24.6404*(1-sex) + 22.1758*sex) + obese*(27.4774*(1-sex) + 26.8346*sex);   // 8 years old
-ffm_ref(7,_)   = under*(19.2548*(1-sex) + 17.5150*sex) + normales*(21.9058*(1-sex) + 21.2721*sex) + over*(26.5243*(1-sex) + 25.6952*sex) + obese*(30.8636*(1-sex) + 29.2900*sex);   // 9 years old
-ffm_ref(8,_)   = under*(20.3271*(1-sex) + 23.7546*sex) + normales*(26.2985*(1-sex) + 26.4307*sex) + over*(29.6861*(1-sex) + 32.5531*sex) + obese*(36.6630*(1-sex) + 34.1787*sex);   // 10 years old
-ffm_ref(9,_)   = under*(25.5568*(1-sex) + 21.2704*sex) + normales*(27.4862*(1-sex) + 28.8484*sex) + over*(32.8810*(1-sex) + 34.9192*sex) + obese*(39.1109*(1-sex) + 39.0934*sex);   // 11 years old
-ffm_ref(10,_)   = under*(27.9345*(1-sex) + 27.7570*sex) + normales*(31.5756*(1-sex) + 33.3547*sex) + over*(36.9403*(1-sex) + 39.1253*sex) + obese*(44.0610*(1-sex) + 43.9033*sex);   // 12 years old
-ffm_ref(11,_)   = under*(30.1592*(1-sex) + 26.9376*sex) + normales*(35.7001*(1-sex) + 36.2985*sex) + over*(43.5796*(1-sex) + 41.3549*sex) + obese*(48.3233*(1-sex) + 47.0629*sex);   // 13 years old
-ffm_ref(12,_)   = under*(21.2736*(1-sex) + 29.2222*sex) + normales*(40.4352*(1-sex) + 37.1184*sex) + over*(47.0679*(1-sex) + 44.8448*sex) + obese*(56.7861*(1-sex) + 47.6488*sex);   // 14 years old
-ffm_ref(13,_)   = under*(36.1157*(1-sex) + 34.1242*sex) + normales*(43.2381*(1-sex) + 40.0629*sex) + over*(50.7450*(1-sex) + 45.9011*sex) + obese*(58.3804*(1-sex) + 50.1206*sex);   // 15 years old
-ffm_ref(14,_)   = under*(41.8846*(1-sex) + 38.1473*sex) + normales*(44.8314*(1-sex) + 40.0155*sex) + over*(54.5065*(1-sex) + 44.8730*sex) + obese*(60.6145*(1-sex) + 51.3464*sex);   // 16 years old
-ffm_ref(15,_)   = under*(40.5722*(1-sex) + 36.5821*sex) + normales*(48.7226*(1-sex) + 41.6682*sex) + over*(57.3895*(1-sex) + 48.4993*sex) + obese*(60.3961*(1-sex) + 53.4969*sex);   // 17 years old
-ffm_ref(16,_)   = under*(42.7400*(1-sex) + 31.2639*sex) + normales*(49.7806*(1-sex) + 41.8400*sex) + over*(58.2319*(1-sex) + 47.9007*sex) + obese*(61.8395*(1-sex) + 51.3603*sex);   // 18 years old
-  }
-
-NumericVector ffm_ref_t(nind);
-int jmin;
-int jmax;
-double diff;
-for(int i=0;i<nind;i++){
-  if(t(i)>=18.0){
-    ffm_ref_t(i)=ffm_ref(16,i);
-  }else{
-    jmin=floor(t(i));
-    jmin=std::max(jmin,2);
-    jmin=jmin-2;
-    jmax= std::min(jmin+1,17);
-    diff= t(i)-floor(t(i));
-    ffm_ref_t(i)=ffm_ref(jmin,i)+diff*(ffm_ref(jmax,i)-ffm_ref(jmin,i));
-  } 
-}
-return ffm_ref_t;
+//Reference fat free mass at age t from the reference pack
+NumericVector Child::FFMReference(NumericVector t){
+    PerfScope scope(perf.get(), "Reference");
+    NumericVector ffm_ref_t(nind);
+    for (int i = 0; i < nind; i++){
+        ffm_ref_t(i) = reference->FFM(sex(i), bmiCat(i), t(i));
+    }
+    return ffm_ref_t;
 }
 
+//Reference fat mass at age t from the reference pack
 NumericVector Child::FMReference(NumericVector t){
-   /* return fm_beta0 + fm_beta1*t;*/
-NumericVector under = ifelse(bmiCat == 1, 1.0, 0.0);
-NumericVector normales = ifelse(bmiCat == 2, 1.0, 0.0);
-NumericVector over = ifelse(bmiCat == 3, 1.0, 0.0);
-NumericVector obese = ifelse(bmiCat == 4, 1.0, 0.0);
-
-NumericMatrix fm_ref(17,nind);
- if(referenceValues == 0){
-  // ---------------------------------------- Mean values
-
-fm_ref(0,_)   = 2.456*(1-sex)+ 2.433*sex;       // 2 years old
-fm_ref(1,_)   = 2.576*(1 - sex) + 2.606*sex;    // 3 years old
-fm_ref(2,_)   = 2.7*(1 - sex) + 2.8*sex;        // 4 years old
-fm_ref(3,_)   = 3.66*(1 - sex) + 4.47*sex;      // 5 years old
-fm_ref(4,_)   = under*(1.7764*(1-sex) + 2.5951*sex) + normales*(3.4540*(1-sex) + 3.8303*sex) + over*(4.8055*(1-sex) + 5.7014*sex) + obese*(7.9672*(1-sex) + 9.3883*sex);   // 6 years old
-fm_ref(5,_)   = under*(2.3398*(1-sex) + 2.8164*sex) + normales*(3.5859*(1-sex) + 4.2782*sex) + over*(5.4625*(1-sex) + 6.5960*sex) + obese*( 8.4350*(1-sex) + 10.4148*sex);   // 7 years old
-fm_ref(6,_)   = under*(3.2767*(1-sex) + 3.0828*sex) + normales*(4.1138*(1-sex) + 5.2226*sex) + over*(5.5455*(1-sex) + 7.3667*sex) + obese*( 9.3266*(1-sex) + 12.0550*sex);   // 8 years old
-fm_ref(7,_)   = under*(2.3902*(1-sex) + 2.6538*sex) + normales*(4.1705*(1-sex) + 5.0218*sex) + over*(6.6958*(1-sex) + 8.6945*sex) + obese*(11.5896*(1-sex) + 14.1436*sex);   // 9 years old
-fm_ref(8,_)   = under*(2.4479*(1-sex) + 3.2454*sex) + normales*(4.9982*(1-sex) + 5.4190*sex) + over*(7.9746*(1-sex) + 9.1949*sex) + obese*(16.3177*(1-sex) + 13.9706*sex);   // 10 years old
-fm_ref(9,_)   = under*(3.3203*(1-sex) + 2.6392*sex) + normales*(5.4113*(1-sex) + 6.0374*sex) + over*( 8.9515*(1-sex) + 10.9333*sex) + obese*(16.9403*(1-sex) + 18.6393*sex);   // 11 years old
-fm_ref(10,_)   = under*(3.4905*(1-sex) + 3.7443*sex) + normales*(6.3199*(1-sex) + 7.1416*sex) + over*(10.7410*(1-sex) + 12.6422*sex) + obese*(20.7120*(1-sex) + 23.3028*sex);   // 12 years old
-fm_ref(11,_)   = under*(3.7085*(1-sex) + 3.2124*sex) + normales*(7.0187*(1-sex) + 8.4339*sex) + over*(13.6491*(1-sex) + 14.2744*sex) + obese*(23.7980*(1-sex) + 24.5466*sex);   // 13 years old
-fm_ref(12,_)   = under*(1.9970*(1-sex) + 3.9076*sex) + normales*(8.1211*(1-sex) + 8.7344*sex) + over*(15.2322*(1-sex) + 16.2757*sex) + obese*(30.4881*(1-sex) + 28.6411*sex);   // 14 years old
-fm_ref(13,_)   = under*(4.2798*(1-sex) + 3.8050*sex) + normales*(8.5973*(1-sex) + 9.8169*sex) + over*(16.8229*(1-sex) + 17.9753*sex) + obese*(32.0464*(1-sex) + 29.0900*sex);   // 15 years old
-fm_ref(14,_)   = under*(4.6019*(1-sex) + 4.5292*sex) + normales*(9.1734*(1-sex) + 9.8278*sex) + over*(19.3477*(1-sex) + 16.1585*sex) + obese*(32.1754*(1-sex) + 30.8017*sex);   // 16 years old
-fm_ref(15,_)   = under*(4.2804*(1-sex) + 4.3746*sex) + normales*(10.0719*(1-sex) +  9.8915*sex) + over*(20.2305*(1-sex) + 18.4581*sex) + obese*(30.7093*(1-sex) + 35.2589*sex);   // 17 years old
-fm_ref(16,_)   = under*(4.9325*(1-sex) + 3.3333*sex) + normales*(11.1103*(1-sex) +  9.3370*sex) + over*(21.0289*(1-sex) + 18.4491*sex) + obese*(36.5275*(1-sex) + 30.2936*sex);   // 18 years old
-
- }
-
- if(referenceValues == 1){
-  // ---------------------------------------- Median values
-
-fm_ref(0,_)   = 2.456*(1-sex)+ 2.433*sex;       // 2 years old
-fm_ref(1,_)   = 2.576*(1 - sex) + 2.606*sex;    // 3 years old
-fm_ref(2,_)   = 2.7*(1 - sex) + 2.8*sex;        // 4 years old
-fm_ref(3,_)   = 3.66*(1 - sex) + 4.47*sex;      // 5 years old
-fm_ref(4,_)   = under*(2.0359*(1-sex) + 2.5660*sex) + normales*(3.4642*(1-sex) + 3.7042*sex) + over*(4.6220*(1-sex) + 5.6735*sex) + obese*(7.1058*(1-sex) + 8.7339*sex);   // 6 years old
-fm_ref(5,_)   = under*(2.3771*(1-sex) + 2.9560*sex) + normales*(3.6030*(1-sex) + 4.1865*sex) + over*(5.5651*(1-sex) + 6.4374*sex) + obese*(8.0501*(1-sex) + 9.3100*sex);   // 7 years old
-fm_ref(6,_)   = under*(2.1231*(1-sex) + 3.0917*sex) + normales*(3.6729*(1-sex) + 4.8531*sex) + over*(5.8971*(1-sex) + 7.0172*sex) + obese*( 8.9372*(1-sex) + 11.5469*sex);   // 8 years old
-fm_ref(7,_)   = under*(2.4068*(1-sex) + 2.9027*sex) + normales*(4.0597*(1-sex) + 4.8707*sex) + over*(6.5720*(1-sex) + 8.7112*sex) + obese*(10.8084*(1-sex) + 12.7559*sex);   // 9 years old
-fm_ref(8,_)   = under*(2.4479*(1-sex) + 3.2454*sex) + normales*(4.9982*(1-sex) + 5.4190*sex) + over*(7.9746*(1-sex) + 9.1949*sex) + obese*(16.3177*(1-sex) + 13.9706*sex);   // 10 years old
-fm_ref(9,_)   = under*(3.3203*(1-sex) + 2.6392*sex) + normales*(5.4113*(1-sex) + 6.0374*sex) + over*( 8.9515*(1-sex) + 10.9333*sex) + obese*(16.9403*(1-sex) + 18.6393*sex);   // 11 years old
-fm_ref(10,_)   = under*(3.4905*(1-sex) + 3.7443*sex) + normales*(6.3199*(1-sex) + 7.1416*sex) + over*(10.7410*(1-sex) + 12.6422*sex) + obese*(20.7120*(1-sex) + 23.3028*sex);   // 12 years old
-fm_ref(11,_)   = under*(3.7085*(1-sex) + 3.2124*sex) + normales*(7.0187*(1-sex) + 8.4339*sex) + over*(13.6491*(1-sex) + 14.2744*sex) + obese*(23.7980*(1-sex) + 24.5466*sex);   // 13 years old
-fm_ref(12,_)   = under*(1.9970*(1-sex) + 3.9076*sex) + normales*(8.1211*(1-sex) + 8.7344*sex) + over*(15.2322*(1-sex) + 16.2757*sex) + obese*(30.4881*(1-sex) + 28.6411*sex);   // 14 years old
-fm_ref(13,_)   = under*(4.2798*(1-sex) + 3.8050*sex) + normales*(8.5973*(1-sex) + 9.8169*sex) + over*(16.8229*(1-sex) + 17.9753*sex) + obese*(32.0464*(1-sex) + 29.0900*sex);   // 15 years old
-fm_ref(14,_)   = under*(4.6585*(1-sex) + 4.5292*sex) + normales*(9.1734*(1-sex) + 9.8278*sex) + over*(19.3477*(1-sex) + 16.1585*sex) + obese*(32.1754*(1-sex) + 30.8017*sex);   // 16 years old
-fm_ref(15,_)   = under*(4.2804*(1-sex) + 4.3746*sex) + normales*(10.0719*(1-sex) +  9.8915*sex) + over*(20.2305*(1-sex) + 18.4581*sex) + obese*(30.7093*(1-sex) + 35.2589*sex);   // 17 years old
-fm_ref(16,_)   = under*(4.9325*(1-sex) + 3.3333*sex) + normales*(11.1103*(1-sex) +  9.3370*sex) + over*(21.0289*(1-sex) + 18.4491*sex) + obese*(36.5275*(1-sex) + 30.2936*sex);   // 18 years old
- }
-
-
-
-  
-NumericVector fm_ref_t(nind);
-int jmin;
-int jmax;
-double diff;
-for(int i=0;i<nind;i++){
-  if(t(i)>=18.0){
-    fm_ref_t(i)=fm_ref(16,i);
-  }else{
-    jmin=floor(t(i));
-    jmin=std::max(jmin,2);
-    jmin=jmin-2;
-    jmax= std::min(jmin+1,17);
-    diff= t(i)-floor(t(i));
-    fm_ref_t(i)=fm_ref(jmin,i)+diff*(fm_ref(jmax,i)-fm_ref(jmin,i));
-  } 
-}
-return fm_ref_t;
+    PerfScope scope(perf.get(), "Reference");
+    NumericVector fm_ref_t(nind);
+    for (int i = 0; i < nind; i++){
+        fm_ref_t(i) = reference->FM(sex(i), bmiCat(i), t(i));
+    }
+    return fm_ref_t;
 }
 
 NumericVector Child::IntakeReference(NumericVector t){
@@ -330,7 +233,7 @@ NumericVector Child::Expenditure(NumericVector t, NumericVector FFM, NumericVect
 }
 
 //Rungue Kutta 4 method for Adult
-List Child::rk4 (double days){
+List Child::rk4 (double days, List control){
     
     //Initial time
     NumericMatrix k1, k2, k3, k4;
@@ -338,56 +241,246 @@ List Child::rk4 (double days){
     //Estimate number of elements to loop into
     int nsims = floor(days/dt);
     
-    //Create array of states
-    NumericMatrix ModelFFM(nind, nsims + 1); //in rcpp
-    NumericMatrix ModelFM(nind, nsims + 1); //in rcpp
-    NumericMatrix ModelBW(nind, nsims + 1); //in rcpp
-    NumericMatrix AGE(nind, nsims + 1); //in rcpp
-    NumericVector TIME(nsims + 1); //in rcpp
+    //Create array of states of all individuals or of the sample in
+    //control$retain (see trajectory_recorder.h)
+    //Matrices of the handle in control$output are overwritten (see outputMatrix in control.h)
+    TrajectoryRecorder recorder(nind, nsims, control);
+    NumericMatrix ModelFFM = recorder.matrix<NumericMatrix>(control, "Fat_Free_Mass");
+    NumericMatrix ModelFM  = recorder.matrix<NumericMatrix>(control, "Fat_Mass");
+    NumericMatrix ModelBW  = recorder.matrix<NumericMatrix>(control, "Body_Weight");
+    NumericMatrix AGE      = recorder.matrix<NumericMatrix>(control, "Age");
+    NumericVector TIME     = outputVector<NumericVector>(control, "Time", nsims + 1);
+    
+    //Current states of all individuals
+    NumericVector ffm   = clone(FFM);
+    NumericVector fm    = clone(FM);
+    NumericVector age_t = clone(age);
+    NumericVector ffm1, fm1;
+    
+    //Energy balance residual of each step from the derivatives at its start
+    //(the first stage) as the model runs (see energy_residual.h)
+    std::shared_ptr<EnergyResidual> residual;
+    if (control.containsElementNamed("residual_tol")){
+        residual = std::make_shared<EnergyResidual>(nsims, dt, controlValue(control, "residual_tol", 1.0), 4);
+    }
     
     //Create initial states
-    ModelFFM(_,0) = FFM;
-    ModelFM(_,0)  = FM;
-    ModelBW(_,0)  = FFM + FM;
     TIME(0)  = 0.0;
-    AGE(_,0)  = age;
+    recorder.record(ModelFFM, "Fat_Free_Mass", 0, ffm);
+    recorder.record(ModelFM, "Fat_Mass", 0, fm);
+    recorder.record(ModelBW, "Body_Weight", 0, ffm + fm);
+    recorder.record(AGE, "Age", 0, age_t);
     
     //Loop through all other states
     bool correctVals = true;
     for (int i = 1; i <= nsims; i++){
 
+        //Phases measured with control$perf (see perf_counters.h)
+        PerfScope derivatives(perf.get(), "Derivatives");
         
         //Rungue kutta 4 (https://en.wikipedia.org/wiki/Runge%E2%80%93Kutta_methods)
-        k1 = dMass(AGE(_,i-1), ModelFFM(_,i-1), ModelFM(_,i-1));
-        k2 = dMass(AGE(_,i-1) + 0.5 * dt/365.0, ModelFFM(_,i-1) + 0.5 * k1(0,_), ModelFM(_,i-1) + 0.5 * k1(1,_));
-        k3 = dMass(AGE(_,i-1) + 0.5 * dt/365.0, ModelFFM(_,i-1) + 0.5 * k2(0,_), ModelFM(_,i-1) + 0.5 * k2(1,_));
-        k4 = dMass(AGE(_,i-1) + dt/365.0, ModelFFM(_,i-1) + k3(0,_), ModelFM(_,i-1) +  k3(1,_));
+        k1 = dMass(age_t, ffm, fm);
+        k2 = dMass(age_t + 0.5 * dt/365.0, ffm + 0.5 * dt * k1(0,_), fm + 0.5 * dt * k1(1,_));
+        k3 = dMass(age_t + 0.5 * dt/365.0, ffm + 0.5 * dt * k2(0,_), fm + 0.5 * dt * k2(1,_));
+        k4 = dMass(age_t + dt/365.0, ffm + dt * k3(0,_), fm + dt * k3(1,_));
         
         //Update of function values
         //Note: The dt is factored from the k1, k2, k3, k4 defined on the Wikipedia page and that is why
         //      it appears here.
-        ModelFFM(_,i) = ModelFFM(_,i-1) + dt*(k1(0,_) + 2.0*k2(0,_) + 2.0*k3(0,_) + k4(0,_))/6.0;        //ffm
-        ModelFM(_,i)  = ModelFM(_,i-1)  + dt*(k1(1,_) + 2.0*k2(1,_) + 2.0*k3(1,_) + k4(1,_))/6.0;        //fm
+        ffm1 = ffm + dt*(k1(0,_) + 2.0*k2(0,_) + 2.0*k3(0,_) + k4(0,_))/6.0;        //ffm
+        fm1  = fm  + dt*(k1(1,_) + 2.0*k2(1,_) + 2.0*k3(1,_) + k4(1,_))/6.0;        //fm
         
-        //Update weight
-        ModelBW(_,i) = ModelFFM(_,i) + ModelFM(_,i);
+        if (residual.get() != NULL){
+            addResidual(*residual, i, age_t, ffm, fm, k1, ffm1, fm1);
+        }
+        ffm = ffm1;
+        fm  = fm1;
         
         //Update TIME(i-1)
         TIME(i) = TIME(i-1) + dt; // Currently time counts the time (days) passed since start of model
         
         //Update AGE variable
-        AGE(_,i) = AGE(_,i-1) + dt/365.0; //Age is variable in years
+        age_t = age_t + dt/365.0; //Age is variable in years
+        derivatives.stop();
+        
+        //Update weight
+        PerfScope recording(perf.get(), "Recording");
+        recorder.record(ModelFFM, "Fat_Free_Mass", i, ffm);
+        recorder.record(ModelFM, "Fat_Mass", i, fm);
+        recorder.record(ModelBW, "Body_Weight", i, ffm + fm);
+        recorder.record(AGE, "Age", i, age_t);
     }
     
-    return List::create(Named("Time") = TIME,
-                        Named("Age") = AGE,
-                        Named("Fat_Free_Mass") = ModelFFM,
-                        Named("Fat_Mass") = ModelFM,
-                        Named("Body_Weight") = ModelBW,
-                        Named("Correct_Values")=correctVals,
-                        Named("Model_Type")="Children");
+    List result = List::create(Named("Time") = TIME,
+                               Named("Age") = AGE,
+                               Named("Fat_Free_Mass") = ModelFFM,
+                               Named("Fat_Mass") = ModelFM,
+                               Named("Body_Weight") = ModelBW,
+                               Named("Correct_Values")=correctVals,
+                               Named("Model_Type")="Children");
+    
+    if (recorder.sampled()){
+        result.push_back(recorder.retained(), "Retained");
+        result.push_back(recorder.aggregates(TIME), "Aggregates");
+    }
+    
+    if (recorder.regressing()){
+        result.push_back(recorder.regressions(TIME), "Regressions");
+    }
+    
+    if (residual.get() != NULL){
+        result.push_back(residual->list(), "Energy_Residual");
+    }
+    
+    return result;
 
+}
 
+//Low-storage Runge Kutta (see low_storage_rk.h). Only the states and one
+//register per state are kept between stages.
+List Child::lowStorage(double days, const LowStorageScheme& scheme, List control){
+    
+    NumericMatrix k;
+    
+    int nsims = floor(days/dt);
+    
+    NumericMatrix ModelFFM = outputMatrix<NumericMatrix>(control, "Fat_Free_Mass", nind, nsims + 1);
+    NumericMatrix ModelFM  = outputMatrix<NumericMatrix>(control, "Fat_Mass", nind, nsims + 1);
+    NumericMatrix ModelBW  = outputMatrix<NumericMatrix>(control, "Body_Weight", nind, nsims + 1);
+    NumericMatrix AGE      = outputMatrix<NumericMatrix>(control, "Age", nind, nsims + 1);
+    NumericVector TIME     = outputVector<NumericVector>(control, "Time", nsims + 1);
+    
+    //States and registers
+    NumericVector yFFM  = clone(FFM);
+    NumericVector yFM   = clone(FM);
+    NumericVector dyFFM(nind);
+    NumericVector dyFM(nind);
+    
+    //Energy balance residual of each step from the derivatives at its start
+    //(the first stage) as the model runs (see energy_residual.h)
+    std::shared_ptr<EnergyResidual> residual;
+    if (control.containsElementNamed("residual_tol")){
+        residual = std::make_shared<EnergyResidual>(nsims, dt, controlValue(control, "residual_tol", 1.0),
+                                                    scheme.order);
+    }
+    NumericVector ffm0, fm0;
+    NumericMatrix start;
+    
+    ModelFFM(_,0) = yFFM;
+    ModelFM(_,0)  = yFM;
+    ModelBW(_,0)  = yFFM + yFM;
+    TIME(0)       = 0.0;
+    AGE(_,0)      = age;
+    
+    bool correctVals = true;
+    for (int i = 1; i <= nsims; i++){
+        
+        if (residual.get() != NULL){
+            ffm0 = clone(yFFM);
+            fm0  = clone(yFM);
+        }
+        
+        for (int s = 0; s < scheme.stages; s++){
+            k = dMass(AGE(_,i-1) + scheme.c[s]*dt/365.0, yFFM, yFM);
+            if (s == 0){
+                start = k;
+            }
+            for (int j = 0; j < nind; j++){
+                dyFFM(j) = scheme.A[s]*dyFFM(j) + dt*k(0,j);
+                dyFM(j)  = scheme.A[s]*dyFM(j)  + dt*k(1,j);
+                yFFM(j) += scheme.B[s]*dyFFM(j);
+                yFM(j)  += scheme.B[s]*dyFM(j);
+            }
+        }
+        
+        if (residual.get() != NULL){
+            addResidual(*residual, i, AGE(_,i-1), ffm0, fm0, start, yFFM, yFM);
+        }
+        
+        ModelFFM(_,i) = yFFM;
+        ModelFM(_,i)  = yFM;
+        ModelBW(_,i)  = yFFM + yFM;
+        TIME(i)       = TIME(i-1) + dt;
+        AGE(_,i)      = AGE(_,i-1) + dt/365.0;
+    }
+    
+    List result = List::create(Named("Time") = TIME,
+                               Named("Age") = AGE,
+                               Named("Fat_Free_Mass") = ModelFFM,
+                               Named("Fat_Mass") = ModelFM,
+                               Named("Body_Weight") = ModelBW,
+                               Named("Correct_Values")=correctVals,
+                               Named("Model_Type")="Children");
+    
+    if (residual.get() != NULL){
+        result.push_back(residual->list(), "Energy_Residual");
+    }
+    
+    return result;
+}
+
+//Run the model and the checks requested in control
+List Child::integrate(double days, std::string method, List control){
+    
+    //Time and hardware counters of the phases (see perf_counters.h)
+    if (controlValue(control, "perf", 0) != 0){
+        perf = std::make_shared<PerfProfile>();
+    }
+    
+    //Stochastic intake shared by clusters (e.g. households)
+    if (control.containsElementNamed("noise")){
+        List options = control["noise"];
+        noise = IntakeNoise(noiseKeys(options, "cluster"), noiseKeys(options, "id"),
+                            as<double>(options["sd_cluster"]),
+                            as<double>(options["sd_individual"]),
+                            (uint64_t) as<double>(options["seed"]),
+                            as<std::string>(options["process"]), dt);
+    }
+    
+    //Both methods add the energy balance check from their stages
+    List result;
+    const LowStorageScheme* scheme = lowStorageScheme(method);
+    if (scheme != NULL){
+        result = lowStorage(days, *scheme, control);
+    } else {
+        result = rk4(days, control);
+    }
+    
+    if (perf.get() != NULL){
+        result.push_back(perf->report(), "Performance");
+        perf.reset();
+    }
+    
+    return result;
+}
+
+//Energy stored in the body (kcal): integral of rhoFFM = 4.3*FFM + 837 plus rhoFM*FM
+NumericVector Child::energyStored(NumericVector FFM, NumericVector FM){
+    return 2.15*pow(FFM, 2.0) + 837.0*FFM + rhoFM*FM;
+}
+
+//Energy balance residual of the step from (FFM0, FM0) at age t (with
+//derivatives k0) to (FFM1, FM1). The change in stored energy is compared
+//against the integral of intake minus expenditure over the step (Simpson's
+//rule with the midpoint state taken from the cubic Hermite interpolant of the
+//step). Intake is constant within a step so its end is evaluated just inside it.
+void Child::addResidual(EnergyResidual& residual, int i, NumericVector t,
+                        NumericVector FFM0, NumericVector FM0, NumericMatrix k0,
+                        NumericVector FFM1, NumericVector FM1){
+    
+    NumericMatrix k1 = dMass(t + (dt - 1.e-6*dt)/365.0, FFM1, FM1);
+    
+    //Hermite midpoint: y(t + h/2) = (y0 + y1)/2 + h*(f0 - f1)/8
+    NumericVector FFMm = 0.5*(FFM0 + FFM1) + 0.125*dt*(k0(0,_) - k1(0,_));
+    NumericVector FMm  = 0.5*(FM0 + FM1) + 0.125*dt*(k0(1,_) - k1(1,_));
+    NumericMatrix km   = dMass(t + 0.5*dt/365.0, FFMm, FMm);
+    
+    //Simpson's rule for intake - expenditure = rhoFFM*dFFM + rhoFM*dFM
+    NumericVector balance = dt*(cRhoFFM(FFM0)*k0(0,_) + rhoFM*k0(1,_) +
+                                4.0*(cRhoFFM(FFMm)*km(0,_) + rhoFM*km(1,_)) +
+                                cRhoFFM(FFM1)*k1(0,_) + rhoFM*k1(1,_))/6.0;
+    
+    residual.add(i, energyStored(FFM1, FM1) - energyStored(FFM0, FM0), balance);
 }
 
 NumericMatrix  Child::dMass (NumericVector t, NumericVector FFM, NumericVector FM){
@@ -450,14 +543,65 @@ void Child::getParameters(void){
     tauD1     = 0.69*(1 - sex) + 0.69*sex;
 }
 
+void Child::setParameters(List values){
+    
+    if (values.size() == 0){
+        return;
+    }
+    
+    //General constants
+    const char* names[] = {"rhoFM", "deltamin", "P", "h"};
+    double* constants[] = {&rhoFM, &deltamin, &P, &h};
+    for (int k = 0; k < 4; k++){
+        if (values.containsElementNamed(names[k])){
+            *constants[k] = as<double>(values[names[k]]);
+        }
+    }
+    
+    //Sex specific constants
+    const char* bySex[] = {"ffm_beta0", "ffm_beta1", "fm_beta0", "fm_beta1", "K", "deltamax",
+                           "A", "B", "D", "tA", "tB", "tD", "tauA", "tauB", "tauD",
+                           "A_EB", "B_EB", "D_EB", "tA_EB", "tB_EB", "tD_EB",
+                           "tauA_EB", "tauB_EB", "tauD_EB",
+                           "A1", "B1", "D1", "tA1", "tB1", "tD1", "tauA1", "tauB1", "tauD1"};
+    NumericVector* vectors[] = {&ffm_beta0, &ffm_beta1, &fm_beta0, &fm_beta1, &K, &deltamax,
+                                &A, &B, &D, &tA, &tB, &tD, &tauA, &tauB, &tauD,
+                                &A_EB, &B_EB, &D_EB, &tA_EB, &tB_EB, &tD_EB,
+                                &tauA_EB, &tauB_EB, &tauD_EB,
+                                &A1, &B1, &D1, &tA1, &tB1, &tD1, &tauA1, &tauB1, &tauD1};
+    for (int k = 0; k < 33; k++){
+        if (values.containsElementNamed(bySex[k])){
+            NumericVector value = values[bySex[k]];
+            const double male   = value(0);
+            const double female = value.size() > 1 ? value(1) : value(0);
+            *vectors[k] = male*(1 - sex) + female*sex;
+        }
+    }
+}
+
 
 //Intake in calories
 NumericVector Child::Intake(NumericVector t){
+    
+    //Example: Age: 6 and t: 7.1 => timeval = 401 which corresponds to the 401 entry of matrix.
+    //The tolerance takes the rounding of the ages out of the row so it does not
+    //depend on which individual comes first. It is well below the 1e-6 steps
+    //that evaluate the end of a step just inside it (see addResidual).
+    int timeval = floor(365.0*(t(0) - age(0))/dt + 1.e-9);
+    
+    NumericVector intake;
     if (generalized_logistic) {
-        return A_logistic + (K_logistic - A_logistic)/pow(C_logistic + Q_logistic*exp(-B_logistic*t), 1/nu_logistic); //t in years
+        intake = A_logistic + (K_logistic - A_logistic)/pow(C_logistic + Q_logistic*exp(-B_logistic*t), 1/nu_logistic); //t in years
     } else {
-        int timeval = floor(365.0*(t(0) - age(0))/dt); //Example: Age: 6 and t: 7.1 => timeval = 401 which corresponds to the 401 entry of matrix
-        return EIntake(timeval,_);
+        intake = EIntake(timeval,_);
+    }
+    
+    //Cluster and individual noise (see intake_noise.h)
+    if (noise.active){
+        for (int i = 0; i < nind; i++){
+            intake(i) += noise.value(i, timeval);
+        }
     }
     
+    return intake;
 }
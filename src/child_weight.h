@@ -32,17 +32,23 @@
 
 #include <math.h>
 #include <Rcpp.h>
+#include "reference_pack.h"
+#include "intake_noise.h"
+#include "low_storage_rk.h"
+#include "perf_counters.h"
 using namespace Rcpp;
 
+class EnergyResidual;
+
 //Create a Adult class to contain individual parameters
 //--------------------------------------------------------------------------------
 class Child {
 public:
     
     //Constructor and destroyer
-    Child(NumericVector input_age, NumericVector input_sex, NumericVector input_bmiCat, NumericVector input_FFM, NumericVector input_FM, NumericMatrix input_EIntake, double input_dt, bool checkValues, double input_referenceValues);
+    Child(NumericVector input_age, NumericVector input_sex, NumericVector input_bmiCat, NumericVector input_FFM, NumericVector input_FM, NumericMatrix input_EIntake, double input_dt, bool checkValues, std::string input_referenceValues);
     Child(NumericVector input_age, NumericVector input_sex,  NumericVector input_bmiCat, NumericVector input_FFM, NumericVector input_FM,  double input_K, double input_Q, double input_A, double input_B, double input_nu, double input_C,
-          double input_dt, bool checkValues, double input_referenceValues);
+          double input_dt, bool checkValues, std::string input_referenceValues);
     
     ~Child(void);
     
@@ -54,11 +60,20 @@ public:
     NumericVector FM;   //Fat Mass (kg)
     NumericMatrix EIntake;
     bool          check; // Check values are correct
-    double referenceValues; //
+    std::string referenceValues; //Name of the reference pack
+    
+    //Time and hardware counters of the phases with control$perf (see perf_counters.h)
+    std::shared_ptr<PerfProfile> perf;
     
     //Functions
     //---------------------------------------------------------------------------
-    List rk4(double days);
+    List rk4(double days, List control);
+    List lowStorage(double days, const LowStorageScheme& scheme, List control);
+    List integrate(double days, std::string method, List control);
+    
+    //Constants given in control$parameters instead of those of the model. Those
+    //that depend on sex take one value for both or one for each (male, female).
+    void setParameters(List values);
     
     //Reference functions for reference children
     NumericVector IntakeReference(NumericVector t);
@@ -78,6 +93,12 @@ private:
     //Number of individuals
     int nind;
     
+    //Reference values of FFM and FM
+    std::shared_ptr<const ReferencePack> reference;
+    
+    //Noise added to the intake
+    IntakeNoise noise;
+    
     //Constants additional
     NumericVector K;
     NumericVector deltamax;
@@ -146,6 +167,10 @@ private:
     NumericVector Expenditure(NumericVector t, NumericVector FFM, NumericVector FM);
     NumericVector Intake(NumericVector t);
     NumericMatrix dMass (NumericVector time, NumericVector FFM, NumericVector FM);
+    NumericVector energyStored(NumericVector FFM, NumericVector FM);
+    void addResidual(EnergyResidual& residual, int i, NumericVector t,
+                     NumericVector FFM0, NumericVector FM0, NumericMatrix k0,
+                     NumericVector FFM1, NumericVector FM1);
 };
 
 
@@ -19,6 +19,7 @@
 //  B               .-  Richardson parameter
 //  nu              .-  Richardson parameter
 //  C               .-  Richardson parameter
+//  method          .-  Integration method: "RK4", "LSRK3" or "LSRK4".
 //  Note:
 //  Weight = FFM + FM. No extracellular fluid or glycogen is considered
 //  Please see child_weight.hpp for additional information
@@ -74,31 +75,34 @@
 
 #include <Rcpp.h>
 #include "child_weight.h"
+#include "control.h"
 
 // [[Rcpp::export]]
-List child_weight_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, NumericMatrix input_EIntake, double days, double dt, bool checkValues, double referenceValues){
+List child_weight_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, NumericMatrix input_EIntake, double days, double dt, bool checkValues, std::string referenceValues, std::string method, List control){
     
     //Create new adult with characteristics
     Child Person (age,  sex, bmiCat, FFM, FM, input_EIntake, dt, checkValues, referenceValues);
+    Person.setParameters(controlList(control, "parameters"));
     
     //Run model using RK4
-    return Person.rk4(days - 1); //days - 1 to account for extra day (c++ indexing starts in 0; R in 1)
+    return Person.integrate(days - 1, method, control); //days - 1 to account for extra day (c++ indexing starts in 0; R in 1)
     
 }
 
 // [[Rcpp::export]]
-List child_weight_wrapper_richardson(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double K, double Q, double A, double B, double nu, double C, double days, double dt, bool checkValues, double referenceValues){
+List child_weight_wrapper_richardson(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double K, double Q, double A, double B, double nu, double C, double days, double dt, bool checkValues, std::string referenceValues, std::string method, List control){
     
     //Create new adult with characteristics
     Child Person (age,  sex, bmiCat, FFM, FM, K, Q, A, B, nu, C, dt, checkValues, referenceValues);
+    Person.setParameters(controlList(control, "parameters"));
     
     //Run model using RK4
-    return Person.rk4(days - 1); //days - 1 to account for extra day (c++ indexing starts in 0; R in 1)
+    return Person.integrate(days - 1, method, control); //days - 1 to account for extra day (c++ indexing starts in 0; R in 1)
     
 }
 
 // [[Rcpp::export]]
-NumericMatrix intake_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double days,  double dt, double referenceValues){
+NumericMatrix intake_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, NumericVector FFM, NumericVector FM, double days,  double dt, std::string referenceValues){
     
     //Energy intake input empty matrix
     NumericMatrix EI(1,1);
@@ -119,7 +123,7 @@ NumericMatrix intake_reference_wrapper(NumericVector age, NumericVector sex, Num
 }
 
 // [[Rcpp::export]]
-List mass_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, double referenceValues){
+List mass_reference_wrapper(NumericVector age, NumericVector sex, NumericVector bmiCat, std::string referenceValues){
     
     //Input empty matrices
     NumericMatrix EI(1,1);
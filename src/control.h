@@ -0,0 +1,99 @@
+//
+//  control.h
+//
+//  Helpers to read the options in the control list given to
+//  adult_weight and child_weight.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef control_h
+#define control_h
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+//Value of an element of the control list or its default
+inline double controlValue(List control, const char* name, double value){
+    if (control.containsElementNamed(name)){
+        return as<double>(control[name]);
+    }
+    return value;
+}
+
+//String element of the control list or its default
+inline std::string controlString(List control, const char* name, const char* value){
+    if (control.containsElementNamed(name)){
+        return as<std::string>(control[name]);
+    }
+    return value;
+}
+
+//List element of the control list (empty if not given)
+inline List controlList(List control, const char* name){
+    if (control.containsElementNamed(name)){
+        return as<List>(control[name]);
+    }
+    return List();
+}
+
+//Matrix name of the handle in control$output (an environment made by
+//bw_output) that the model writes over instead of allocating a new one. The
+//handle keeps the matrices of its last run: those of another type or size are
+//allocated and replace them. Without a handle the matrix is new.
+template <typename T>
+inline T outputMatrix(List control, const char* name, int nrow, int ncol){
+    if (!control.containsElementNamed("output")){
+        return T(nrow, ncol);
+    }
+    Environment output = control["output"];
+    if (output.exists(name) && is<T>(output.get(name))){
+        T x = as<T>(output.get(name));
+        if (x.nrow() == nrow && x.ncol() == ncol){
+            return x;
+        }
+    }
+    T x(nrow, ncol);
+    output.assign(name, x);
+    return x;
+}
+
+template <typename T>
+inline T outputVector(List control, const char* name, int n){
+    if (!control.containsElementNamed("output")){
+        return T(n);
+    }
+    Environment output = control["output"];
+    if (output.exists(name) && is<T>(output.get(name))){
+        T x = as<T>(output.get(name));
+        if (x.size() == n){
+            return x;
+        }
+    }
+    T x(n);
+    output.assign(name, x);
+    return x;
+}
+
+#endif /* control_h */
@@ -0,0 +1,111 @@
+//
+//  disease_risk.cpp
+//
+//  Expected cases of diseases accumulated step by step (see disease_risk.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include "disease_risk.h"
+#include "thread_governor.h"
+
+DiseaseRisk::DiseaseRisk(const std::vector<std::vector<double> >& bmi,
+                         const std::vector<std::vector<double> >& logRR,
+                         const double* h0, const double* w, const int* group,
+                         int n, int ngroups, int nsteps, double step, int threads) :
+    n(n), ngroups(ngroups), nsteps(nsteps), threads(std::max(1, threads)), step(step),
+    bmi(bmi), logRR(logRR), h0(h0, h0 + n*logRR.size()), w(w, w + n),
+    group(n, 0){
+
+    if (group != NULL){
+        this->group.assign(group, group + n);
+    }
+
+    const int D = logRR.size();
+    H.assign(n*D, 0.0);
+    last.assign(n*D, 0.0);
+    initial.assign(n*D, 0.0);
+    expected.assign(D*nsteps*ngroups, 0.0);
+    counterfactual.assign(D*nsteps*ngroups, 0.0);
+}
+
+double DiseaseRisk::logRelativeRisk(int disease, double x) const {
+
+    const std::vector<double>& knots = bmi[disease];
+    const std::vector<double>& value = logRR[disease];
+    if (x <= knots.front()){
+        return value.front();
+    }
+    if (x >= knots.back()){
+        return value.back();
+    }
+
+    //Segment of the table with x (the tables have a few rows)
+    int k = std::upper_bound(knots.begin(), knots.end(), x) - knots.begin();
+    double u = (x - knots[k - 1])/(knots[k] - knots[k - 1]);
+    return value[k - 1] + u*(value[k] - value[k - 1]);
+}
+
+void DiseaseRisk::add(int t, const double* x){
+
+    const int D = logRR.size();
+
+    //Ranges of individuals of each thread with their own sums by group
+    int nchunks = std::max(1, std::min(threads, n/256));
+    std::vector<std::vector<double> > parts(nchunks);
+
+    parallelFor(nchunks, threads, [&](int c){
+        std::vector<double>& part = parts[c];
+        part.assign(2*D*ngroups, 0.0);
+        int begin = (int) ((long long) n*c/nchunks);
+        int end   = (int) ((long long) n*(c + 1)/nchunks);
+        for (int d = 0; d < D; d++){
+            double* cases = &part[d*ngroups];
+            double* base  = &part[(D + d)*ngroups];
+            for (int i = begin; i < end; i++){
+                int    r = d*n + i;
+                double h = h0[r]*exp(logRelativeRisk(d, x[i]));
+                if (t == 0){
+                    initial[r] = h;
+                } else {
+                    H[r] += 0.5*step*(last[r] + h);
+                }
+                last[r] = h;
+                cases[group[i]] += w[i]*(1.0 - exp(-H[r]));
+                base[group[i]]  += w[i]*(1.0 - exp(-initial[r]*step*t));
+            }
+        }
+    });
+
+    //Sums of the threads in a fixed order
+    for (int c = 0; c < nchunks; c++){
+        for (int d = 0; d < D; d++){
+            for (int g = 0; g < ngroups; g++){
+                expected[(d*nsteps + t)*ngroups + g]       += parts[c][d*ngroups + g];
+                counterfactual[(d*nsteps + t)*ngroups + g] += parts[c][(D + d)*ngroups + g];
+            }
+        }
+    }
+}
@@ -0,0 +1,98 @@
+//
+//  disease_risk.h
+//
+//  Expected incident cases of diseases related to the body mass index (e.g.
+//  diabetes, hypertension, cardiovascular disease) accumulated as the model
+//  runs so that the BMI trajectories are not stored. The hazard (per year)
+//  of individual i for disease d is
+//
+//      h_id(t) = h0_id * exp(logRR_d(BMI_i(t)))
+//
+//  where h0 is the hazard at log relative risk 0 and logRR_d is piecewise
+//  linear between the BMI of its table (constant outside of it). Each step
+//  adds the trapezoid of h to the cumulative hazard H_id, and the expected
+//  cases are sum w_i (1 - exp(-H_id)) of each group. The cases of the
+//  baseline (the hazard at the initial BMI kept constant) are also
+//  accumulated so that their difference gives the cases averted.
+//
+//  Example:
+//      DiseaseRisk risk(bmi, logRR, h0, w, group, n, ngroups, nsteps, dt/365.0, threads);
+//      for (int t = 0; t < nsteps; t++){
+//          risk.add(t, bmi_t);
+//      }
+//      double averted = risk.baseline(d, t, g) - risk.cases(d, t, g);
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef disease_risk_h
+#define disease_risk_h
+
+#include <vector>
+
+class DiseaseRisk {
+public:
+
+    //bmi and logRR are the (increasing) BMI of the table of each disease and
+    //its log relative risk; h0 is n x D by column, group from 0 to G - 1 (NULL
+    //for a single group) and step the years between steps
+    DiseaseRisk(const std::vector<std::vector<double> >& bmi,
+                const std::vector<std::vector<double> >& logRR,
+                const double* h0, const double* w, const int* group,
+                int n, int ngroups, int nsteps, double step, int threads);
+
+    int diseases(void) const { return logRR.size(); }
+    int groups(void) const { return ngroups; }
+
+    //Adds the BMI of the n individuals at step (steps are added in order from 0)
+    void add(int step, const double* bmi);
+
+    //Expected cases of disease in group by step and those of the baseline
+    double cases(int disease, int step, int group) const {
+        return expected[(disease*nsteps + step)*ngroups + group];
+    }
+    double baseline(int disease, int step, int group) const {
+        return counterfactual[(disease*nsteps + step)*ngroups + group];
+    }
+
+private:
+
+    //Log relative risk of disease at the BMI x
+    double logRelativeRisk(int disease, double x) const;
+
+    int n, ngroups, nsteps, threads;
+    double step;
+    std::vector<std::vector<double> > bmi, logRR;
+    std::vector<double> h0, w;
+    std::vector<int>    group;
+
+    //Cumulative hazard, hazard at the last step and at the initial BMI of each
+    //individual and disease (n x D by column)
+    std::vector<double> H, last, initial;
+
+    //Expected cases of each disease, step and group
+    std::vector<double> expected, counterfactual;
+};
+
+#endif /* disease_risk_h */
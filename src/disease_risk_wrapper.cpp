@@ -0,0 +1,56 @@
+//
+//  disease_risk_wrapper.cpp
+//
+//  Expected cases of diseases from the stored BMI trajectories of a model in
+//  one pass (see disease_risk.h).
+//
+//  Input:
+//  BMI             .-  Body mass index of each individual (rows) by step.
+//  risk            .-  Relative risk tables, hazards, weights, groups and
+//                      costs checked by risk_control.
+//  TIME            .-  Time of each step.
+//  threads         .-  Threads of the accumulation (0 for the budget).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include "trajectory_recorder.h"
+using namespace Rcpp;
+
+// [[Rcpp::export]]
+List risk_wrapper(NumericMatrix BMI, List risk, NumericVector TIME, int threads){
+    
+    if (BMI.ncol() != TIME.size()){
+        stop("Invalid Body_Mass_Index: it must have one column per step.");
+    }
+    
+    //Recorder that only accumulates the cases of every step
+    List control = List::create(Named("risk") = risk, Named("threads") = threads);
+    TrajectoryRecorder recorder(BMI.nrow(), TIME.size() - 1, control);
+    for (int i = 0; i < BMI.ncol(); i++){
+        recorder.assess("Body_Mass_Index", i, BMI(_, i));
+    }
+    
+    return recorder.risks(TIME);
+}
@@ -11,6 +11,8 @@
 //  otherwise the model does not make any sense.
 //  interpol .- Interpolation mode: linear, exponential, stepwise_r, stepwise_l, 
 //  brownian and logarihmmic.
+//  dt       .- Time step of the grid: the columns of the result are the times
+//  0, dt, 2dt, ... (the grid of the solvers) up to the last measurement.
 //
 //  Authors:
 //  Dalia Camacho-García-Formentí
@@ -37,22 +39,22 @@
 
 #include <Rcpp.h>
 #include <math.h>
+#include <vector>
+#include "energy_source_wrapper.h"
 using namespace Rcpp;
 
 // [[Rcpp::export]]
 NumericMatrix EnergyBuilder(NumericMatrix Energy, NumericVector Time, 
-                            std::string interpol){
+                            std::string interpol, double dt){
   
-
+  //Measurement times are on the grid up to rounding
+  const double eps = 1.e-9;
   
-  //Number of times to calculate
-  int days = floor(Time(Time.size()-1));
-  int j    = 0; //indicator of time value we are taking
+  //Number of steps to calculate
+  int steps = ceil(Time(Time.size()-1)/dt - eps);
   
   //Numeric matrix to return
-  NumericMatrix Evalues(Energy.nrow(), days + 1);
-  
-  double K = 5000; //To avoid logarithm starting at 0 we displace the exponential to let for a maximum y2 - y1 of 1000.
+  NumericMatrix Evalues(Energy.nrow(), steps + 1);
   
   //Brownian bridge
   if (interpol.compare("Brownian") == 0){
@@ -63,46 +65,57 @@ NumericMatrix EnergyBuilder(NumericMatrix Energy, NumericVector Time,
      double T = Time(j+1);
      double t = Time(j);
      
+     //Steps of the grid between the measurements
+     int first = ceil(t/dt - eps);
+     int last  = floor(T/dt + eps);
+     
+     //Times after t at which W is simulated: the steps within (t, T) and T
+     std::vector<double> s;
+     for (int k = first; k <= last; k++){
+       if (k*dt - t > eps*dt && T - k*dt > eps*dt){
+         s.push_back(k*dt);
+       }
+     }
+     s.push_back(T);
+     
      //Simulate W brownian path
-     NumericMatrix W(Energy.nrow(), (T - t) + 1); //By default W(_, 0) = 0;
-     for (int i = 1; i < (T - t + 1); i++){
-       W(_, i) = W(_,i-1) + rnorm(Energy.nrow());
+     NumericMatrix W(Energy.nrow(), s.size() + 1); //By default W(_, 0) = 0;
+     for (int i = 1; i < (int) s.size() + 1; i++){
+       double h = s[i-1] - (i > 1 ? s[i-2] : t);
+       W(_, i) = W(_,i-1) + sqrt(h)*rnorm(Energy.nrow());
      }
      
-     //Get brownian bridge
-     for (int i = 0 ; i < (T - t + 1); i++){
-       Evalues(_,i + t) = Energy(_,j)*( (T - t) - i )/(T - t) + Energy(_,j+1)*i/(T-t) + 
-         W(_, i) -  (i/(T-t))*W(_, (T-t));  
+     //Get brownian bridge at the steps of the grid
+     int m = 0;
+     for (int k = first; k <= last; k++){
+       double i = k*dt - t;
+       if (i > eps*dt){
+         m++;
+       }
+       if (T - k*dt <= eps*dt){
+         i = T - t;
+       }
+       Evalues(_,k) = Energy(_,j)*( (T - t) - i )/(T - t) + Energy(_,j+1)*i/(T-t) + 
+         W(_, m) -  (i/(T-t))*W(_, s.size());  
      }
    }
+    
+    //Last step (after the last measurement when it is not on the grid)
+    if (steps*dt - Time(Time.size()-1) > eps*dt){
+      Evalues(_, steps) = Energy(_,Energy.ncol() - 1);
+    }
    
   } else {
     
-    //Case; exponential; logarithmic or stepwise
-    for (int i = 0; i < days; i++){
-      
-      //Linear case
-      if (interpol.compare("Linear") == 0){
-        Evalues(_,i) =  (Energy(_, j + 1) - Energy(_, j))/(Time(j+1) - Time(j))*(i - Time(j)) + 
-          Energy(_, j);
-      } else if (interpol.compare("Stepwise_L") == 0){
-        Evalues(_,i) = Energy(_,j);
-      } else if (interpol.compare("Stepwise_R") == 0){
-        Evalues(_,i) = Energy(_,j+1);
-      } else if (interpol.compare("Exponential") == 0){
-        Evalues(_,i) =  exp((log(Energy(_, j + 1) - Energy(_, j) + K) - log(K))/(Time(j+1) - Time(j))*(i - Time(j)) + log(K)) - K + Energy(_, j);
-      } else if (interpol.compare("Logarithmic") == 0){
-        Evalues(_,i) =  1000*log( (exp( (Energy(_, j + 1) - Energy(_, j))/1000) -1)/(Time(j+1) - Time(j))*(i - Time(j)) + 1) + Energy(_,j);
-      } 
-      
-      //Update to next time
-      if (i + 1 >= Time(j + 1)){
-          j = j + 1;  
+    //Case; linear; exponential; logarithmic or stepwise (see energy_source.h)
+    std::shared_ptr<EnergySource> source = energySource(Energy, Time, interpol);
+    for (int k = 0; k < steps; k++){
+      for (int i = 0; i < Energy.nrow(); i++){
+        Evalues(i,k) = source->value(i, k*dt);
       }
-      
     }
     
-    //Last day
+    //Last step
     Evalues(_, Evalues.ncol() - 1) = Energy(_,Energy.ncol() - 1);
     
   }
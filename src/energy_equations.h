@@ -0,0 +1,138 @@
+//
+//  energy_equations.h
+//
+//  Resting metabolic rate (RMR) and initial extracellular fluid (ECF)
+//  equations of the adult model. Each equation is a policy (a struct with a
+//  static function) so that it can be inlined into the loops that use it.
+//  All of them take body weight bw (kg), height ht (m), age (yrs) and
+//  sex (0 = "male", 1 = "female") and return kcal/day (RMR) or kg (ECF).
+//  The equations with age groups are the ones for adults (ages below 30
+//  use the 18-30 group).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Mifflin, Mark D, Sachiko T St Jeor, Lisa A Hill, Barbara J Scott, Sandra A Daugherty, and YO Koh. 1990.
+//      “A New Predictive Equation for Resting Energy Expenditure in Healthy Individuals.” The American Journal of Clinical Nutrition 51 (2).
+//      Am Soc Nutrition: 241–47.
+//
+//  Harris, J Arthur, and Francis G Benedict. 1918. “A Biometric Study of Human Basal Metabolism.”
+//      Proceedings of the National Academy of Sciences 4 (12): 370–73.
+//
+//  Schofield, WN. 1985. “Predicting Basal Metabolic Rate, New Standards and Review of Previous Work.”
+//      Human Nutrition. Clinical Nutrition 39 Suppl 1: 5–41.
+//
+//  Henry, CJK. 2005. “Basal Metabolic Rate Studies in Humans: Measurement and Development of New Equations.”
+//      Public Health Nutrition 8 (7a): 1133–52.
+//
+//  Silva, Analiza M, Jack Wang, Richard N Pierson, ZiMian Wang, Steven B Heymsfield, Luís B Sardinha,
+//      and Stanley Heshka. 2005. “Extracellular Water: Greater Expansion with Age in African Americans.”
+//      Journal of Applied Physiology 99 (1): 261–67.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef energy_equations_h
+#define energy_equations_h
+
+//Codes of the RMR equations (in the order of the rmr argument of adult_weight)
+//--------------------------------------------------------------------------------
+enum RMREquation {
+    RMR_MIFFLIN         = 0,
+    RMR_HARRIS_BENEDICT = 1,
+    RMR_SCHOFIELD       = 2,
+    RMR_HENRY           = 3
+};
+
+//Resting metabolic rate policies
+//--------------------------------------------------------------------------------
+struct MifflinStJeor {
+    static inline double rmr(double bw, double ht, double age, double sex){
+        return 9.99*bw + 625.0*ht - 4.92*age + 5.0 - 166.0*sex;
+    }
+};
+
+struct HarrisBenedict {
+    static inline double rmr(double bw, double ht, double age, double sex){
+        return (66.473 + 13.7516*bw + 500.33*ht - 6.755*age)*(1.0 - sex) +
+               (655.0955 + 9.5634*bw + 184.96*ht - 4.6756*age)*sex;
+    }
+};
+
+struct Schofield {
+    static inline double rmr(double bw, double /* ht */, double age, double sex){
+        double male, female;
+        if (age < 30){
+            male   = 15.057*bw + 692.2;
+            female = 14.818*bw + 486.6;
+        } else if (age < 60){
+            male   = 11.472*bw + 873.1;
+            female = 8.126*bw + 845.6;
+        } else {
+            male   = 11.711*bw + 587.7;
+            female = 9.082*bw + 658.5;
+        }
+        return male*(1.0 - sex) + female*sex;
+    }
+};
+
+struct Henry {
+    static inline double rmr(double bw, double ht, double age, double sex){
+        double male, female;
+        if (age < 30){
+            male   = 14.4*bw + 313.0*ht + 113.0;
+            female = 10.4*bw + 615.0*ht - 282.0;
+        } else if (age < 60){
+            male   = 11.4*bw + 541.0*ht - 137.0;
+            female = 8.18*bw + 502.0*ht - 11.6;
+        } else {
+            male   = 11.4*bw + 541.0*ht - 256.0;
+            female = 8.52*bw + 421.0*ht + 10.7;
+        }
+        return male*(1.0 - sex) + female*sex;
+    }
+};
+
+//Same as the policies for a code of RMREquation (for scalar code)
+inline double restingMetabolicRate(int equation, double bw, double ht, double age, double sex){
+    switch (equation){
+        case RMR_HARRIS_BENEDICT:
+            return HarrisBenedict::rmr(bw, ht, age, sex);
+        case RMR_SCHOFIELD:
+            return Schofield::rmr(bw, ht, age, sex);
+        case RMR_HENRY:
+            return Henry::rmr(bw, ht, age, sex);
+        default:
+            return MifflinStJeor::rmr(bw, ht, age, sex);
+    }
+}
+
+//Initial extracellular fluid policies
+//--------------------------------------------------------------------------------
+struct Silva {
+    static inline double ecf(double bw, double ht, double age, double sex){
+        return (0.025*age + 9.57*ht + 0.191*bw - 12.4)*(1.0 - sex) + (-4.0 + 5.98*ht + 0.167*bw)*sex;
+    }
+};
+
+#endif /* energy_equations_h */
@@ -0,0 +1,63 @@
+//
+//  energy_residual.cpp
+//
+//  Energy balance residual accumulated step by step (see energy_residual.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+#include <math.h>
+#include <algorithm>
+#include "energy_residual.h"
+
+EnergyResidual::EnergyResidual(int nsims, double dt, double tol, int order) :
+    RES(nsims + 1), dt(dt), tol(tol), order(order), maxres(0.0), sumsq(0.0), n(0.0){
+    
+}
+
+void EnergyResidual::add(int step, NumericVector stored, NumericVector balance){
+    
+    //Diverged steps (NaN) count as infinite residuals
+    NumericVector res = abs(stored - balance)/dt;
+    res        = ifelse(is_nan(res), R_PosInf, res);
+    RES(step)  = max(res);
+    maxres     = std::max(maxres, RES(step));
+    sumsq     += sum(res*res);
+    n         += res.size();
+}
+
+List EnergyResidual::list() const {
+    
+    //Residuals of a method of order p shrink as dt^p
+    double rms   = (n > 0) ? sqrt(sumsq/n) : 0.0;
+    double newdt = (order > 0) ? dt : NA_REAL;
+    if (order > 0 && maxres > 0){
+        newdt = 0.9*dt*pow(tol/maxres, 1.0/order);
+    }
+    
+    return List::create(Named("Residual") = RES,
+                        Named("Max") = maxres,
+                        Named("RMS") = rms,
+                        Named("Tolerance") = tol,
+                        Named("Within_Tolerance") = (maxres <= tol),
+                        Named("Recommended_dt") = newdt);
+}
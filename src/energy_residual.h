@@ -0,0 +1,74 @@
+//
+//  energy_residual.h
+//
+//  Energy balance residual of a run (control$residual_tol). At each step the
+//  change in energy stored in the body is compared against the integral of
+//  intake minus expenditure over the step. Both agree up to the error of the
+//  integrator so the residual (kcal/day) measures how far the numerical
+//  solution is from conserving energy. The residuals of all the individuals
+//  are added step by step as the model runs, so they do not need the stored
+//  trajectories (and cover everyone when control$retain keeps a sample).
+//
+//  Example:
+//      EnergyResidual residual(nsims, dt, tol, 4);
+//      for (int i = 1; i <= nsims; i++){
+//          ...
+//          residual.add(i, stored, balance);
+//      }
+//      List summary = residual.list();
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+
+#ifndef energy_residual_h
+#define energy_residual_h
+
+#include <Rcpp.h>
+using namespace Rcpp;
+
+class EnergyResidual {
+public:
+    
+    //Residuals of nsims steps of size dt of a method of order p (0 when its
+    //error is not set by dt alone)
+    EnergyResidual(int nsims, double dt, double tol, int order);
+    
+    //Adds the change in stored energy and the integral of intake minus
+    //expenditure (kcal) over step of all the individuals
+    void add(int step, NumericVector stored, NumericVector balance);
+    
+    //Largest residual of each step, its Max and RMS, whether it is
+    //Within_Tolerance and the Recommended_dt to bring it to the tolerance
+    List list() const;
+    
+private:
+    NumericVector RES;
+    double dt;
+    double tol;
+    int    order;
+    double maxres;
+    double sumsq;
+    double n;
+};
+
+#endif /* energy_residual_h */
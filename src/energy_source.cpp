@@ -0,0 +1,103 @@
+//
+//  energy_source.cpp
+//
+//  Intake change interpolated between measurements (see energy_source.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+#include "energy_source.h"
+
+//To avoid logarithm starting at 0 we displace the exponential to let for a maximum y2 - y1 of 1000.
+static const double K = 5000;
+
+EnergySource::EnergySource(const std::vector<double>& input_energy, int input_nrow,
+                           const std::vector<double>& input_time,
+                           const std::string& interpolation) :
+    nrow(input_nrow), energy(input_energy.size()), time(input_time){
+    
+    if (interpolation.compare("Linear") == 0){
+        kind = LINEAR;
+    } else if (interpolation.compare("Exponential") == 0){
+        kind = EXPONENTIAL;
+    } else if (interpolation.compare("Logarithmic") == 0){
+        kind = LOGARITHMIC;
+    } else if (interpolation.compare("Stepwise_L") == 0){
+        kind = STEPWISE_L;
+    } else if (interpolation.compare("Stepwise_R") == 0){
+        kind = STEPWISE_R;
+    } else {
+        throw std::invalid_argument("Invalid interpolation of the energy source: " + interpolation);
+    }
+    if (time.empty() || input_energy.size() != nrow*time.size()){
+        throw std::invalid_argument("The energy source needs one value per individual and time.");
+    }
+    
+    const int ntime = time.size();
+    for (int i = 0; i < nrow; i++){
+        for (int j = 0; j < ntime; j++){
+            energy[i*ntime + j] = input_energy[i + j*nrow];
+        }
+    }
+}
+
+int EnergySource::size(void) const {
+    return nrow;
+}
+
+double EnergySource::last(int i) const {
+    return energy[(i + 1)*time.size() - 1];
+}
+
+double EnergySource::value(int i, double t) const {
+    
+    const int ntime = time.size();
+    if (ntime == 1 || t >= time[ntime - 1]){
+        return last(i);
+    }
+    
+    //Measurements j and j + 1 around t: time[j] <= t < time[j + 1]
+    int j = std::upper_bound(time.begin(), time.end(), t) - time.begin() - 1;
+    j     = std::max(j, 0);
+    
+    const double E0 = energy[i*ntime + j];
+    const double E1 = energy[i*ntime + j + 1];
+    const double T0 = time[j];
+    const double T1 = time[j + 1];
+    
+    switch (kind){
+        case LINEAR:
+            return (E1 - E0)/(T1 - T0)*(t - T0) + E0;
+        case EXPONENTIAL:
+            return exp((log(E1 - E0 + K) - log(K))/(T1 - T0)*(t - T0) + log(K)) - K + E0;
+        case LOGARITHMIC:
+            return 1000*log( (exp( (E1 - E0)/1000) -1)/(T1 - T0)*(t - T0) + 1) + E0;
+        case STEPWISE_L:
+            return E0;
+        default:
+            return E1;
+    }
+}
@@ -0,0 +1,71 @@
+//
+//  energy_source.h
+//
+//  Intake change of each individual interpolated between measurements at
+//  any (fractional) time. energy_build evaluates it on the grid of the solver
+//  (steps of dt) and adult_weight can evaluate it directly at the stage
+//  times of the integrator instead of reading a matrix row (lazy source).
+//  It does not depend on R (see energy_source_wrapper.h to build it from R
+//  objects) so the kernels of adult_kernel.h can use it.
+//
+//  Example:
+//      EnergySource source(energy, nrow, time, "Linear");
+//      double e = source.value(i, 0.5*dt);   //individual i (row of energy)
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef energy_source_h
+#define energy_source_h
+
+#include <vector>
+#include <string>
+
+class EnergySource {
+public:
+    
+    //energy is a matrix by column (as R stores it) of nrow rows, one per
+    //individual, and one column per measurement made at time (increasing,
+    //from 0). interpolation is "Linear", "Exponential", "Logarithmic",
+    //"Stepwise_L" or "Stepwise_R" (Brownian bridges are random and are built
+    //by EnergyBuilder only); others throw std::invalid_argument.
+    EnergySource(const std::vector<double>& energy, int nrow, const std::vector<double>& time,
+                 const std::string& interpolation);
+    
+    //Energy of individual i at time t; the last measurement holds afterwards.
+    //Does not call R so it can be used from several threads.
+    double value(int i, double t) const;
+    
+    int    size(void) const;
+    double last(int i) const;
+    
+private:
+    enum Kind {LINEAR, EXPONENTIAL, LOGARITHMIC, STEPWISE_L, STEPWISE_R};
+    Kind kind;
+    int  nrow;
+    std::vector<double> energy;     //By individual: energy[i*ntime + j]
+    std::vector<double> time;
+};
+
+#endif /* energy_source_h */
@@ -0,0 +1,365 @@
+//
+//  intake_inverse.cpp
+//
+//  Estimation of the change in energy intake from observed weights
+//  (see intake_inverse.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <stdexcept>
+#include "intake_inverse.h"
+#include "thread_governor.h"
+
+//Square matrices are stored by columns: A[i + j*n]
+//--------------------------------------------------------------------------------
+
+//Cholesky factorization A = L L' (L is left in the lower triangle of A).
+//Returns false when A is not positive definite (or has NaN).
+static bool cholesky(std::vector<double>& A, int n){
+    for (int j = 0; j < n; j++){
+        double d = A[j + j*n];
+        for (int k = 0; k < j; k++){
+            d -= A[j + k*n]*A[j + k*n];
+        }
+        if (!(d > 0)){
+            return false;
+        }
+        d = sqrt(d);
+        A[j + j*n] = d;
+        for (int i = j + 1; i < n; i++){
+            double s = A[i + j*n];
+            for (int k = 0; k < j; k++){
+                s -= A[i + k*n]*A[j + k*n];
+            }
+            A[i + j*n] = s/d;
+        }
+    }
+    return true;
+}
+
+//Solves L L' x = b overwriting b
+static void choleskySolve(const std::vector<double>& L, int n, double* b){
+    for (int i = 0; i < n; i++){
+        double s = b[i];
+        for (int k = 0; k < i; k++){
+            s -= L[i + k*n]*b[k];
+        }
+        b[i] = s/L[i + i*n];
+    }
+    for (int i = n - 1; i >= 0; i--){
+        double s = b[i];
+        for (int k = i + 1; k < n; k++){
+            s -= L[k + i*n]*b[k];
+        }
+        b[i] = s/L[i + i*n];
+    }
+}
+
+//Knot to the left of time t and the weight of the one to its right
+static void knot(double t, double resolution, int nknots, int& k, double& w){
+    double p = t/resolution;
+    k = std::min((int) floor(p), nknots - 2);
+    w = p - k;
+}
+
+//Linear system of the penalized least squares problem
+//--------------------------------------------------------------------------------
+struct InverseSystem {
+    int nknots;
+    std::vector<double> JtJ;    //J'J
+    std::vector<double> Jtz;    //J'z
+    std::vector<double> P;      //D' W D
+    std::vector<double> J;      //Jacobian (nobs x nknots)
+    std::vector<double> z;      //Linearized observations
+    double ridge;
+};
+
+//Solution for lambda; returns false if the matrix is singular. L has the
+//Cholesky factor of J'J + lambda P + ridge I.
+static bool solve(const InverseSystem& S, double lambda, std::vector<double>& u,
+                  std::vector<double>& L){
+    const int n = S.nknots;
+    L.assign(n*n, 0.0);
+    for (int i = 0; i < n*n; i++){
+        L[i] = S.JtJ[i] + lambda*S.P[i];
+    }
+    for (int i = 0; i < n; i++){
+        L[i + i*n] += S.ridge;
+    }
+    if (!cholesky(L, n)){
+        return false;
+    }
+    u = S.Jtz;
+    choleskySolve(L, n, &u[0]);
+    return true;
+}
+
+//Residual sum of squares and trace of the influence matrix J (A^-1) J'
+static void fit(const InverseSystem& S, const std::vector<double>& u, const std::vector<double>& L,
+                double& rss, double& trace){
+    const int n = S.nknots;
+    const int m = S.z.size();
+    rss = 0.0;
+    for (int i = 0; i < m; i++){
+        double r = S.z[i];
+        for (int k = 0; k < n; k++){
+            r -= S.J[i + k*m]*u[k];
+        }
+        rss += r*r;
+    }
+    trace = 0.0;
+    std::vector<double> x(n);
+    for (int k = 0; k < n; k++){
+        for (int i = 0; i < n; i++){
+            x[i] = S.JtJ[i + k*n];
+        }
+        choleskySolve(L, n, &x[0]);
+        trace += x[k];
+    }
+}
+
+//Lambda minimizing the generalized cross validation score
+static double gcv(const InverseSystem& S){
+    const int m = S.z.size();
+    double best = 1.0, score = -1.0;
+    std::vector<double> u, L;
+    for (double e = -14.0; e <= 2.0; e += 0.25){
+        double lambda = pow(10.0, e);
+        double rss, trace;
+        if (!solve(S, lambda, u, L)){
+            continue;
+        }
+        fit(S, u, L, rss, trace);
+        if (m - trace < 0.5){
+            continue;
+        }
+        double value = m*rss/((m - trace)*(m - trace));
+        if (score < 0 || value < score){
+            score = value;
+            best  = lambda;
+        }
+    }
+    return best;
+}
+
+//Body weight at each step for the knots u
+static void forward(AdultKernel& kernel, std::vector<double>& ei, const AdultState& y0,
+                    const std::vector<double>& u, double resolution, int nsteps, double h,
+                    std::vector<double>& BW){
+    const int nknots = u.size();
+    for (size_t s = 0; s < ei.size(); s++){
+        int k;
+        double w;
+        knot(std::min((int) s, nsteps)*h, resolution, nknots, k, w);
+        ei[s] = (1.0 - w)*u[k] + w*u[k + 1];
+    }
+    
+    AdultState y = y0;
+    BW.resize(nsteps + 1);
+    BW[0] = kernel.bodyWeight(y);
+    for (int s = 1; s <= nsteps; s++){
+        kernel.rk4Step((s - 1)*h, h, y);
+        BW[s] = kernel.bodyWeight(y);
+    }
+}
+
+//Inverse problem of one individual
+static InverseResult inverse(const AdultKernel& base, const AdultState& y0,
+                             const InverseObservations& obs, int nsteps, double h,
+                             const InverseOptions& options){
+    
+    const double delta  = 10.0;    //Finite difference step (kcal)
+    const double eps    = 1.0;     //Smoothing of the total variation (kcal)
+    const int    nknots = std::max(2, (int) ceil(nsteps*h/options.resolution) + 1);
+    const int    m      = obs.step.size();
+    const bool   tv     = options.penalty.compare("TV") == 0;
+    
+    //The kernel reads the intake change from ei (and the other inputs from
+    //copies with the same stride)
+    std::vector<double> ei(base.in.nrow), na(base.in.nrow), pal(base.in.nrow);
+    for (int s = 0; s < base.in.nrow; s++){
+        na[s]  = base.in.NAchange[s*base.in.stride];
+        pal[s] = base.in.PAL[s*base.in.stride];
+    }
+    AdultKernel kernel = base;
+    kernel.in.EIchange = &ei[0];
+    kernel.in.NAchange = &na[0];
+    kernel.in.PAL      = &pal[0];
+    kernel.in.stride   = 1;
+    
+    InverseSystem S;
+    S.nknots = nknots;
+    S.J.resize(m*nknots);
+    S.z.resize(m);
+    
+    //Differences of the knots: first (TV) or second (Tikhonov)
+    const int order = tv ? 1 : 2;
+    const int nrows = std::max(0, nknots - order);
+    
+    InverseResult result;
+    result.converged  = false;
+    result.iterations = 0;
+    result.lambda     = options.lambda;
+    
+    std::vector<double> u(nknots, 0.0), u1, L, BW, BW1;
+    forward(kernel, ei, y0, u, options.resolution, nsteps, h, BW);
+    bool singular = false;
+    
+    for (int iter = 0; iter < options.maxiter; iter++){
+        
+        //Jacobian by finite differences
+        for (int k = 0; k < nknots; k++){
+            u1 = u;
+            u1[k] += delta;
+            forward(kernel, ei, y0, u1, options.resolution, nsteps, h, BW1);
+            for (int i = 0; i < m; i++){
+                S.J[i + k*m] = (BW1[obs.step[i]] - BW[obs.step[i]])/delta;
+            }
+        }
+        
+        //Linearized observations z = weight - BW(u) + J u
+        for (int i = 0; i < m; i++){
+            S.z[i] = obs.weight[i] - BW[obs.step[i]];
+            for (int k = 0; k < nknots; k++){
+                S.z[i] += S.J[i + k*m]*u[k];
+            }
+        }
+        
+        S.JtJ.assign(nknots*nknots, 0.0);
+        S.Jtz.assign(nknots, 0.0);
+        double trace = 0.0;
+        for (int k = 0; k < nknots; k++){
+            for (int i = 0; i < m; i++){
+                S.Jtz[k] += S.J[i + k*m]*S.z[i];
+            }
+            for (int l = 0; l < nknots; l++){
+                double s = 0.0;
+                for (int i = 0; i < m; i++){
+                    s += S.J[i + k*m]*S.J[i + l*m];
+                }
+                S.JtJ[k + l*nknots] = s;
+            }
+            trace += S.JtJ[k + k*nknots];
+        }
+        S.ridge = 1.e-10*(1.0 + trace/nknots);
+        
+        //Penalty D' W D (W are the total variation weights)
+        S.P.assign(nknots*nknots, 0.0);
+        for (int r = 0; r < nrows; r++){
+            double d[3] = {-1.0, 1.0, 0.0};
+            if (order == 2){
+                d[0] = 1.0; d[1] = -2.0; d[2] = 1.0;
+            }
+            double w = 1.0;
+            if (tv){
+                w = 1.0/sqrt((u[r + 1] - u[r])*(u[r + 1] - u[r]) + eps*eps);
+            }
+            for (int a = 0; a <= order; a++){
+                for (int b = 0; b <= order; b++){
+                    S.P[(r + a) + (r + b)*nknots] += w*d[a]*d[b];
+                }
+            }
+        }
+        
+        if (options.lambda < 0){
+            result.lambda = gcv(S);
+        }
+        
+        if (!solve(S, result.lambda, u1, L)){
+            singular = true;
+            break;
+        }
+        
+        double change = 0.0;
+        for (int k = 0; k < nknots; k++){
+            change = std::max(change, fabs(u1[k] - u[k]));
+        }
+        u = u1;
+        forward(kernel, ei, y0, u, options.resolution, nsteps, h, BW);
+        result.iterations = iter + 1;
+        
+        if (change < options.tol){
+            result.converged = true;
+            break;
+        }
+    }
+    
+    result.EIchange.resize(nsteps + 1);
+    result.sd.resize(nsteps + 1);
+    result.BW = BW;
+    
+    //A singular system has no covariance: the bands are NaN instead of zero width
+    if (singular){
+        result.converged = false;
+        result.sigma     = options.sd > 0 ? options.sd : NAN;
+        for (int s = 0; s <= nsteps; s++){
+            result.EIchange[s] = ei[s];
+            result.sd[s]       = NAN;
+        }
+        return result;
+    }
+    
+    //Standard deviation of the weights and covariance of the knots sigma^2 A^-1
+    //(L is the factor of the last system solved)
+    double rss, trace;
+    fit(S, u, L, rss, trace);
+    result.sigma = options.sd > 0 ? options.sd : sqrt(rss/std::max(m - trace, 1.0));
+    
+    std::vector<double> cov(nknots*nknots, 0.0);
+    for (int k = 0; k < nknots; k++){
+        cov[k + k*nknots] = 1.0;
+        choleskySolve(L, nknots, &cov[k*nknots]);
+    }
+    
+    for (int s = 0; s <= nsteps; s++){
+        int k;
+        double w;
+        knot(s*h, options.resolution, nknots, k, w);
+        result.EIchange[s] = ei[s];
+        double var = (1.0 - w)*(1.0 - w)*cov[k + k*nknots] + 2.0*w*(1.0 - w)*cov[k + (k + 1)*nknots] +
+                     w*w*cov[(k + 1) + (k + 1)*nknots];
+        result.sd[s] = result.sigma*sqrt(std::max(var, 0.0));
+    }
+    
+    return result;
+}
+
+void intakeInverse(const std::vector<AdultKernel>& kernels, const std::vector<AdultState>& y0,
+                   const std::vector<InverseObservations>& observations, int nsteps, double h,
+                   const InverseOptions& options, std::vector<InverseResult>& results){
+    
+    //At least one system is solved for the covariance of the knots
+    if (options.maxiter < 1 || !(options.tol > 0)){
+        throw std::invalid_argument("Invalid intake control: maxiter must be at least 1 and tol positive.");
+    }
+    
+    const int nind = kernels.size();
+    results.resize(nind);
+    
+    parallelFor(nind, options.threads, [&](int i){
+        results[i] = inverse(kernels[i], y0[i], observations[i], nsteps, h, options);
+    });
+}
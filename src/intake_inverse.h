@@ -0,0 +1,92 @@
+//
+//  intake_inverse.h
+//
+//  Estimation of the change in energy intake of an adult from observed body
+//  weights (inverse problem of the adult model). The intake change is linear
+//  between knots every "resolution" days and is found by Gauss-Newton on
+//
+//      sum (weight - BW(u))^2 + lambda * |D u|^2
+//
+//  where BW(u) is the body weight of AdultKernel::rk4Step with intake change u
+//  and D the second differences of the knots (Tikhonov) or their first
+//  differences reweighted as in total variation (TV). The Jacobian is
+//  computed by finite differences and lambda, when not given, by generalized
+//  cross validation. It contains no R objects so individuals run in threads.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Golub, Gene H, Michael Heath, and Grace Wahba. 1979. “Generalized Cross-Validation as a Method for
+//      Choosing a Good Ridge Parameter.” Technometrics 21 (2): 215–23.
+//
+//  Vogel, Curtis R. 2002. Computational Methods for Inverse Problems. SIAM.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef intake_inverse_h
+#define intake_inverse_h
+
+#include <vector>
+#include <string>
+#include "adult_kernel.h"
+
+//Options of the inverse problem
+//--------------------------------------------------------------------------------
+struct InverseOptions {
+    double      resolution;  //Days between knots of the intake change
+    double      lambda;      //Penalty weight (negative to choose it by GCV)
+    std::string penalty;     //"Tikhonov" or "TV"
+    double      sd;          //Standard deviation of the weights (negative to estimate it)
+    int         maxiter;     //Maximum number of Gauss-Newton iterations
+    double      tol;         //Convergence tolerance of the knots (kcal)
+    int         threads;     //Threads over individuals
+};
+
+//Observed weights of one individual at time steps of the model
+//--------------------------------------------------------------------------------
+struct InverseObservations {
+    std::vector<int>    step;
+    std::vector<double> weight;
+};
+
+//Estimated intake change of one individual at each time step
+//--------------------------------------------------------------------------------
+struct InverseResult {
+    std::vector<double> EIchange;   //Intake change (kcal)
+    std::vector<double> sd;         //Its standard deviation (kcal; NaN if the system is singular)
+    std::vector<double> BW;         //Fitted body weight (kg)
+    double lambda;
+    double sigma;                   //Standard deviation of the weights (kg)
+    int    iterations;
+    bool   converged;
+};
+
+//Estimates the intake change of each individual. kernels[i].in.EIchange is
+//ignored (the estimate is used instead) and the inputs must have at least
+//nsteps + 1 rows.
+void intakeInverse(const std::vector<AdultKernel>& kernels, const std::vector<AdultState>& y0,
+                   const std::vector<InverseObservations>& observations, int nsteps, double h,
+                   const InverseOptions& options, std::vector<InverseResult>& results);
+
+#endif /* intake_inverse_h */
@@ -0,0 +1,156 @@
+//
+//  intake_noise.cpp
+//
+//  Hierarchical stochastic noise for energy intake. The normal draws come
+//  from a counter-based generator: the SplitMix64 finalizer is applied to
+//  the seed, the stream (cluster or individual id) and the step, and the
+//  two resulting uniforms are transformed with Box-Muller.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Salmon, John K, Mark A Moraes, Ron O Dror, and David E Shaw. 2011. “Parallel Random Numbers: As Easy as 1, 2, 3.”
+//      Proceedings of 2011 International Conference for High Performance Computing, Networking, Storage and Analysis, 16:1–12.
+//
+//  Steele, Guy L, Doug Lea, and Christine H Flood. 2014. “Fast Splittable Pseudorandom Number Generators.”
+//      ACM SIGPLAN Notices 49 (10): 453–72.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "intake_noise.h"
+
+static inline uint64_t splitmix64(uint64_t x){
+    x += 0x9E3779B97F4A7C15ULL;
+    x  = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x  = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+//Uniform in (0,1) from the 53 high bits
+static inline double uniform(uint64_t x){
+    return ((x >> 11) + 0.5) * (1.0/9007199254740992.0);
+}
+
+//Streams of clusters and individuals are apart even for equal keys
+static inline uint64_t clusterStream(uint64_t key){
+    return splitmix64(key ^ 0x436C7573746572ULL);
+}
+
+static inline uint64_t individualStream(uint64_t key){
+    return splitmix64(key ^ 0x496E646976ULL);
+}
+
+//-0 and 0 are the same id; integers and doubles of R share the key
+uint64_t noiseKey(double id){
+    uint64_t bits;
+    id = id + 0.0;
+    memcpy(&bits, &id, sizeof(bits));
+    return splitmix64(bits);
+}
+
+//Bytes in blocks of 8; the length and a different start keep strings apart
+//from numbers and from each other
+uint64_t noiseKey(const std::string& id){
+    uint64_t key = 0x537472696E67ULL;
+    for (size_t i = 0; i < id.size(); i += 8){
+        uint64_t block = 0;
+        memcpy(&block, id.data() + i, std::min((size_t) 8, id.size() - i));
+        key = splitmix64(key ^ block);
+    }
+    return splitmix64(key ^ uint64_t(id.size()));
+}
+
+IntakeNoise::IntakeNoise(void){
+    active = false;
+}
+
+IntakeNoise::IntakeNoise(const std::vector<uint64_t>& cluster, const std::vector<uint64_t>& input_id,
+                         double input_sd_cluster, double input_sd_individual, uint64_t input_seed,
+                         std::string process, double dt){
+    
+    active        = true;
+    id            = input_id;
+    sd_cluster    = input_sd_cluster;
+    sd_individual = input_sd_individual;
+    seed          = input_seed;
+    brownian      = (process.compare("White") != 0);
+    sqrtdt        = sqrt(dt);
+    
+    //Each cluster walk is computed once for all its members
+    clusterid = cluster;
+    std::sort(clusterid.begin(), clusterid.end());
+    clusterid.erase(std::unique(clusterid.begin(), clusterid.end()), clusterid.end());
+    
+    clusterIndex.resize(cluster.size());
+    for (size_t i = 0; i < cluster.size(); i++){
+        clusterIndex[i] = std::lower_bound(clusterid.begin(), clusterid.end(), cluster[i]) - clusterid.begin();
+    }
+    
+    Walk start = {0, 0.0, 0.0};
+    clusterWalk    = std::vector<Walk>(clusterid.size(), start);
+    individualWalk = std::vector<Walk>(id.size(), start);
+}
+
+double IntakeNoise::normal(uint64_t stream, int64_t step) const {
+    uint64_t key = splitmix64(seed ^ splitmix64(stream ^ splitmix64(uint64_t(step))));
+    double u1    = uniform(splitmix64(key));
+    double u2    = uniform(splitmix64(key + 1));
+    return sqrt(-2.0*log(u1))*cos(6.283185307179586*u2);
+}
+
+//Random walk W(row) = sqrt(dt)*(Z(1) + ... + Z(row)) with W(0) = 0. The model
+//moves forward one row at a time (and sometimes asks again for the previous
+//row) so only the last two values are kept.
+double IntakeNoise::walk(Walk& w, uint64_t stream, int row){
+    
+    if (row == w.row - 1){
+        return w.previous;
+    }
+    if (row < w.row){
+        w.row = 0; w.value = 0.0; w.previous = 0.0;
+    }
+    while (w.row < row){
+        w.previous = w.value;
+        w.row++;
+        w.value   += sqrtdt*normal(stream, w.row);
+    }
+    return w.value;
+}
+
+double IntakeNoise::value(int i, int row){
+    
+    if (!active){
+        return 0.0;
+    }
+    
+    int c = clusterIndex[i];
+    if (brownian){
+        return sd_cluster*walk(clusterWalk[c], clusterStream(clusterid[c]), row) +
+               sd_individual*walk(individualWalk[i], individualStream(id[i]), row);
+    }
+    return sd_cluster*normal(clusterStream(clusterid[c]), row) +
+           sd_individual*normal(individualStream(id[i]), row);
+}
@@ -0,0 +1,95 @@
+//
+//  intake_noise.h
+//
+//  Hierarchical stochastic noise for energy intake: a component shared by
+//  all the individuals of a cluster (e.g. household) plus an individual
+//  component. Draws are generated by a counter-based generator keyed by
+//  (seed, key of the cluster or individual id, time step) so the noise is
+//  evaluated on the fly without storing paths. The keys are hashes of the ids
+//  themselves, so an id gets the same path in any subset or order of the
+//  population.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef intake_noise_h
+#define intake_noise_h
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Noise of energy intake (kcal/day)
+//--------------------------------------------------------------------------------
+class IntakeNoise {
+public:
+    
+    IntakeNoise(void);
+    
+    //cluster and id are the keys (see noiseKey) of the cluster and individual
+    //id of each individual; dt
+    //is the time step (days) of the rows. process is either "Brownian"
+    //(random walk; sd in kcal/day per sqrt(day)) or "White" (independent
+    //each row; sd in kcal/day).
+    IntakeNoise(const std::vector<uint64_t>& cluster, const std::vector<uint64_t>& id,
+                double sd_cluster, double sd_individual, uint64_t seed,
+                std::string process, double dt);
+    
+    bool active;
+    
+    //Noise of individual i at row (time step) row
+    double value(int i, int row);
+    
+    //Standard normal draw number step of stream (counter-based)
+    double normal(uint64_t stream, int64_t step) const;
+    
+private:
+    
+    //Last values of a random walk (to move one step at a time)
+    struct Walk {
+        int    row;
+        double value;
+        double previous;
+    };
+    
+    std::vector<uint64_t> id;
+    std::vector<uint64_t> clusterid;  //Unique cluster keys
+    std::vector<int>  clusterIndex;   //Position in clusterid of each individual
+    std::vector<Walk> clusterWalk;
+    std::vector<Walk> individualWalk;
+    double   sd_cluster;
+    double   sd_individual;
+    uint64_t seed;
+    bool     brownian;
+    double   sqrtdt;
+    
+    double walk(Walk& w, uint64_t stream, int row);
+};
+
+//Keys of the ids: numbers by their value (bits of the double) and strings by
+//their bytes
+uint64_t noiseKey(double id);
+uint64_t noiseKey(const std::string& id);
+
+#endif /* intake_noise_h */
@@ -0,0 +1,69 @@
+//
+//  low_storage_rk.cpp
+//
+//  Coefficients of the 2N-storage Runge Kutta schemes (see low_storage_rk.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include "low_storage_rk.h"
+
+static const double williamson3A[3] = {0.0, -5.0/9.0, -153.0/128.0};
+static const double williamson3B[3] = {1.0/3.0, 15.0/16.0, 8.0/15.0};
+static const double williamson3c[3] = {0.0, 1.0/3.0, 3.0/4.0};
+
+static const double carpenterKennedy4A[5] = {
+    0.0,
+    -567301805773.0/1357537059087.0,
+    -2404267990393.0/2016746695238.0,
+    -3550918686646.0/2091501179385.0,
+    -1275806237668.0/842570457699.0
+};
+static const double carpenterKennedy4B[5] = {
+    1432997174477.0/9575080441755.0,
+    5161836677717.0/13612068292357.0,
+    1720146321549.0/2090206949498.0,
+    3134564353537.0/4481467310338.0,
+    2277821191437.0/14882151754819.0
+};
+static const double carpenterKennedy4c[5] = {
+    0.0,
+    1432997174477.0/9575080441755.0,
+    2526269341429.0/6820363962896.0,
+    2006345519317.0/3224310063776.0,
+    2802321613138.0/2924317926251.0
+};
+
+const LowStorageScheme Williamson3 = {3, 3, williamson3A, williamson3B, williamson3c};
+
+const LowStorageScheme CarpenterKennedy4 = {5, 4, carpenterKennedy4A, carpenterKennedy4B,
+                                            carpenterKennedy4c};
+
+const LowStorageScheme* lowStorageScheme(const std::string& method){
+    if (method.compare("LSRK3") == 0){
+        return &Williamson3;
+    } else if (method.compare("LSRK4") == 0){
+        return &CarpenterKennedy4;
+    }
+    return NULL;
+}
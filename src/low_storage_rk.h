@@ -0,0 +1,65 @@
+//
+//  low_storage_rk.h
+//
+//  Coefficients of the 2N-storage (low-storage) Runge Kutta schemes. A step
+//  of size h of y' = f(t, y) keeps only y and one register dy:
+//      dy = A[s]*dy + h*f(t + c[s]*h, y)
+//      y  = y + B[s]*dy                       for s = 0, ..., stages - 1
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Williamson, JH. 1980. “Low-Storage Runge-Kutta Schemes.” Journal of Computational Physics 35 (1): 48–56.
+//
+//  Carpenter, Mark H, and Christopher A Kennedy. 1994. “Fourth-Order 2N-Storage Runge-Kutta Schemes.”
+//      NASA Technical Memorandum 109112.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef low_storage_rk_h
+#define low_storage_rk_h
+
+#include <string>
+
+//Coefficients of a 2N-storage scheme
+//--------------------------------------------------------------------------------
+struct LowStorageScheme {
+    int           stages;
+    int           order;
+    const double* A;
+    const double* B;
+    const double* c;
+};
+
+//Williamson's three stage third order scheme
+extern const LowStorageScheme Williamson3;
+
+//Carpenter and Kennedy's five stage fourth order scheme
+extern const LowStorageScheme CarpenterKennedy4;
+
+//Scheme of a method name: "LSRK3" (Williamson3) or "LSRK4" (CarpenterKennedy4).
+//Returns NULL for other names.
+const LowStorageScheme* lowStorageScheme(const std::string& method);
+
+#endif /* low_storage_rk_h */
@@ -0,0 +1,163 @@
+//
+//  output_layout.cpp
+//
+//  Storage order of the trajectories of the models (see output_layout.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include "output_layout.h"
+
+OutputLayout::OutputLayout(std::string name, int tileRows, int tileCols) :
+    tileRows(tileRows), tileCols(tileCols){
+    
+    if (name.compare("Time") == 0){
+        kind = TIME;
+    } else if (name.compare("Individual") == 0){
+        kind = INDIVIDUAL;
+    } else if (name.compare("Tiled") == 0){
+        kind = TILED;
+    } else {
+        stop("Invalid layout '" + name + "'. Please choose 'Time', 'Individual' or 'Tiled'.");
+    }
+    
+    if (tileRows < 1 || tileCols < 1){
+        stop("Invalid tile: it must have at least one individual and one step.");
+    }
+}
+
+std::string OutputLayout::name(void) const {
+    switch (kind){
+        case INDIVIDUAL: return "Individual";
+        case TILED:      return "Tiled";
+        default:         return "Time";
+    }
+}
+
+R_xlen_t OutputLayout::offset(int i, int s, int nrow, int ncol) const {
+    switch (kind){
+        case INDIVIDUAL:
+            return s + ((R_xlen_t) ncol)*i;
+        case TILED: {
+            //Tiles of the last block of individuals (steps) may be smaller
+            const int bi   = i/tileRows, bs = s/tileCols;
+            const int rows = std::min(tileRows, nrow - bi*tileRows);
+            const R_xlen_t start = ((R_xlen_t) bi)*tileRows*ncol + ((R_xlen_t) rows)*bs*tileCols;
+            return start + (i - bi*tileRows) + ((R_xlen_t) rows)*(s - bs*tileCols);
+        }
+        default:
+            return i + ((R_xlen_t) nrow)*s;
+    }
+}
+
+OutputLayout layoutOf(RObject x){
+    if (!x.hasAttribute("layout")){
+        return OutputLayout("Time", 1, 1);
+    }
+    IntegerVector tile = x.attr("tile");
+    return OutputLayout(as<std::string>(x.attr("layout")), tile(0), tile(1));
+}
+
+IntegerVector trajectoryDim(RObject x){
+    if (x.hasAttribute("trajectory_dim")){
+        return x.attr("trajectory_dim");
+    }
+    return x.attr("dim");
+}
+
+//Copies x between layouts visiting it by blocks so that both the source and
+//the destination are read and written in cache sized pieces
+template <int RTYPE>
+static SEXP relayoutVector(SEXP xs, const OutputLayout& from, const OutputLayout& to,
+                           int nrow, int ncol){
+    
+    Vector<RTYPE> x(xs);
+    Vector<RTYPE> y(x.size());
+    const int block = 64;
+    for (int s0 = 0; s0 < ncol; s0 += block){
+        const int s1 = std::min(ncol, s0 + block);
+        for (int i0 = 0; i0 < nrow; i0 += block){
+            const int i1 = std::min(nrow, i0 + block);
+            for (int s = s0; s < s1; s++){
+                for (int i = i0; i < i1; i++){
+                    y[to.offset(i, s, nrow, ncol)] = x[from.offset(i, s, nrow, ncol)];
+                }
+            }
+        }
+    }
+    
+    switch (to.kind){
+        case OutputLayout::TIME:
+            y.attr("dim") = IntegerVector::create(nrow, ncol);
+            return y;
+        case OutputLayout::INDIVIDUAL:
+            y.attr("dim") = IntegerVector::create(ncol, nrow);
+            break;
+        default:
+            break;
+    }
+    y.attr("layout")         = to.name();
+    y.attr("trajectory_dim") = IntegerVector::create(nrow, ncol);
+    y.attr("tile")           = IntegerVector::create(to.tileRows, to.tileCols);
+    return y;
+}
+
+SEXP relayout(RObject x, const OutputLayout& to){
+    
+    const OutputLayout from = layoutOf(x);
+    
+    IntegerVector dim = trajectoryDim(x);
+    const int nrow = dim(0), ncol = dim(1);
+    
+    //Nothing to move
+    if (from.kind == to.kind && (to.kind != OutputLayout::TILED ||
+        (from.tileRows == to.tileRows && from.tileCols == to.tileCols))){
+        return x;
+    }
+    
+    switch (TYPEOF(x)){
+        case REALSXP: return relayoutVector<REALSXP>(x, from, to, nrow, ncol);
+        case INTSXP:  return relayoutVector<INTSXP>(x, from, to, nrow, ncol);
+        case LGLSXP:  return relayoutVector<LGLSXP>(x, from, to, nrow, ncol);
+        case STRSXP:  return relayoutVector<STRSXP>(x, from, to, nrow, ncol);
+        default:      stop("Trajectories must be numeric, integer, logical or character.");
+    }
+    return x;
+}
+
+List relayoutModel(List model, const OutputLayout& to){
+    
+    //New list with the same elements so that model is not modified
+    List result(model.size());
+    result.names() = model.names();
+    for (R_xlen_t k = 0; k < model.size(); k++){
+        RObject x = model[k];
+        if (x.hasAttribute("layout") || Rf_isMatrix(x)){
+            result[k] = relayout(x, to);
+        } else {
+            result[k] = x;
+        }
+    }
+    return result;
+}
@@ -0,0 +1,83 @@
+//
+//  output_layout.h
+//
+//  Storage order of the trajectories (individuals x steps) returned by the
+//  models. The integrators fill them step by step with one column per step
+//  ("Time" layout: the individuals of a step are contiguous). Analyses of
+//  individuals (plots, event times) read a whole row instead so they can be
+//  stored as:
+//      "Individual"  The transpose (steps x individuals); each trajectory is
+//                    contiguous.
+//      "Tiled"       Blocks of tileRows individuals x tileCols steps, each
+//                    contiguous (column major within the block), blocks of
+//                    the same individuals one after the other.
+//  A trajectory stored in other than the Time layout has the attributes
+//  "layout", "trajectory_dim" (individuals and steps) and "tile".
+//
+//  Example:
+//      OutputLayout layout("Individual", 64, 64);
+//      result = relayoutModel(result, layout);
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef output_layout_h
+#define output_layout_h
+
+#include <string>
+#include <Rcpp.h>
+using namespace Rcpp;
+
+class OutputLayout {
+public:
+    
+    enum Kind {TIME, INDIVIDUAL, TILED};
+    
+    OutputLayout(std::string name, int tileRows, int tileCols);
+    
+    Kind kind;
+    int  tileRows;
+    int  tileCols;
+    
+    std::string name(void) const;
+    
+    //Position of individual i at step s of a trajectory of nrow individuals
+    //and ncol steps
+    R_xlen_t offset(int i, int s, int nrow, int ncol) const;
+};
+
+//Layout of the trajectory x (Time when it has no layout attribute)
+OutputLayout layoutOf(RObject x);
+
+//Individuals and steps of the trajectory x in any layout
+IntegerVector trajectoryDim(RObject x);
+
+//Trajectory x stored in the layout to
+SEXP relayout(RObject x, const OutputLayout& to);
+
+//Every trajectory (top level matrix or element with a layout attribute) of
+//a model stored in the layout to
+List relayoutModel(List model, const OutputLayout& to);
+
+#endif /* output_layout_h */
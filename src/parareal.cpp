@@ -0,0 +1,151 @@
+//
+//  parareal.cpp
+//
+//  Time-parallel (Parareal) integration of the adult model for one
+//  individual. The horizon is split into slices; a cheap coarse propagator
+//  runs serially over the slices while the Runge Kutta 4 (fine) propagator
+//  corrects every slice in parallel until the slice boundaries converge:
+//
+//      U[n+1]^(k+1) = G(U[n]^(k+1)) + F(U[n]^k) - G(U[n]^k)
+//
+//  After k iterations the first k slices are exact so the iteration always
+//  ends in at most the number of slices.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Lions, Jacques-Louis, Yvon Maday, and Gabriel Turinici. 2001. “Résolution d'EDP par un schéma en temps pararéel.”
+//      Comptes Rendus de l'Académie des Sciences-Series I-Mathematics 332 (7): 661–68.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include "parareal.h"
+#include "thread_governor.h"
+
+//Fine propagator: rk4 steps first..last-1. If store is true the states after
+//each step (first+1..last) are saved in trajectory; the start of a slice is
+//the end of the previous one so slices never write the same state.
+static AdultState fine(const AdultKernel& kernel, AdultState y, int first, int last,
+                       double h, bool store, std::vector<AdultState>& trajectory){
+    for (int j = first; j < last; j++){
+        kernel.rk4Step(j*h, h, y);
+        if (store){
+            trajectory[j + 1] = y;
+        }
+    }
+    return y;
+}
+
+//Coarse propagator from step first to step last
+static AdultState coarse(const AdultKernel& kernel, AdultState y, int first, int last,
+                         double h, double coarse_dt){
+    double T0 = first*h;
+    double T  = (last - first)*h;
+    int    nc = std::max(1, (int) ceil(T/coarse_dt));
+    for (int j = 0; j < nc; j++){
+        kernel.coarseStep(T0 + j*T/nc, T/nc, y);
+    }
+    return y;
+}
+
+//Relative distance between two states
+static double distance(const AdultState& a, const AdultState& b){
+    double d = 0;
+    d = std::max(d, fabs(a.AT - b.AT)/(1.0 + fabs(b.AT)));
+    d = std::max(d, fabs(a.ECF - b.ECF)/(1.0 + fabs(b.ECF)));
+    d = std::max(d, fabs(a.G - b.G)/(1.0 + fabs(b.G)));
+    d = std::max(d, fabs(a.L - b.L)/(1.0 + fabs(b.L)));
+    return d;
+}
+
+//Runs the fine propagator on slices first..nslices-1 in parallel (see
+//thread_governor.h)
+static void fineSweep(const AdultKernel& kernel, const std::vector<AdultState>& U,
+                      const std::vector<int>& bounds, int first, double h, int nthreads,
+                      bool store, std::vector<AdultState>& Fn,
+                      std::vector<AdultState>& trajectory){
+
+    int nslices = bounds.size() - 1;
+    parallelFor(nslices - first, nthreads, [&](int k){
+        const int n = first + k;
+        Fn[n] = fine(kernel, U[n], bounds[n], bounds[n + 1], h, store, trajectory);
+    });
+}
+
+int parareal(const AdultKernel& kernel, const AdultState& y0, int nsteps, double h,
+             const PararealOptions& options, std::vector<AdultState>& trajectory){
+
+    trajectory.resize(nsteps + 1);
+
+    //Slices are aligned with the fine grid
+    int nslices = std::max(1, std::min(options.slices, nsteps));
+    std::vector<int> bounds(nslices + 1);
+    for (int n = 0; n <= nslices; n++){
+        bounds[n] = (int) (((long long) n * nsteps)/nslices);
+    }
+
+    //Initial coarse sweep
+    std::vector<AdultState> U(nslices + 1), Gold(nslices), Fn(nslices);
+    U[0] = y0;
+    for (int n = 0; n < nslices; n++){
+        Gold[n]  = coarse(kernel, U[n], bounds[n], bounds[n + 1], h, options.coarse_dt);
+        U[n + 1] = Gold[n];
+    }
+
+    //Parareal iterations
+    int k = 0;
+    while (k < std::min(options.maxiter, nslices)){
+
+        //Slices before k already start from the exact value
+        fineSweep(kernel, U, bounds, k, h, options.threads, false, Fn, trajectory);
+
+        //Serial correction
+        double change = 0;
+        std::vector<AdultState> Unew(U);
+        Unew[k + 1] = Fn[k];
+        for (int n = k + 1; n < nslices; n++){
+            AdultState Gnew = coarse(kernel, Unew[n], bounds[n], bounds[n + 1], h, options.coarse_dt);
+            Unew[n + 1].AT  = Gnew.AT  + Fn[n].AT  - Gold[n].AT;
+            Unew[n + 1].ECF = Gnew.ECF + Fn[n].ECF - Gold[n].ECF;
+            Unew[n + 1].G   = Gnew.G   + Fn[n].G   - Gold[n].G;
+            Unew[n + 1].L   = Gnew.L   + Fn[n].L   - Gold[n].L;
+            Gold[n]         = Gnew;
+        }
+        for (int n = k + 1; n <= nslices; n++){
+            change = std::max(change, distance(Unew[n], U[n]));
+        }
+        U = Unew;
+        k++;
+
+        if (change < options.tol){
+            break;
+        }
+    }
+
+    //Final fine sweep from the converged boundaries saving the trajectory
+    trajectory[0] = y0;
+    fineSweep(kernel, U, bounds, 0, h, options.threads, true, Fn, trajectory);
+
+    return k;
+}
@@ -0,0 +1,54 @@
+//
+//  parareal.h
+//
+//  Time-parallel (Parareal) integration of the adult model for one
+//  individual over very long horizons.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef parareal_h
+#define parareal_h
+
+#include <vector>
+#include "adult_kernel.h"
+
+//Options of the Parareal iteration
+//--------------------------------------------------------------------------------
+struct PararealOptions {
+    int    slices;      //Number of time slices
+    int    threads;     //Number of threads for the fine propagator
+    double coarse_dt;   //Time step of the coarse propagator (days)
+    double tol;         //Convergence tolerance on the slice boundaries
+    int    maxiter;     //Maximum number of Parareal iterations
+};
+
+//Integrates nsteps fine steps of size h starting at y0. The fine propagator
+//is AdultKernel::rk4Step and the coarse one AdultKernel::coarseStep.
+//On exit trajectory has the nsteps + 1 fine states and the function returns
+//the number of Parareal iterations used.
+int parareal(const AdultKernel& kernel, const AdultState& y0, int nsteps, double h,
+             const PararealOptions& options, std::vector<AdultState>& trajectory);
+
+#endif /* parareal_h */
@@ -0,0 +1,241 @@
+//
+//  perf_counters.cpp
+//
+//  Time and hardware counters of the phases of the models (see perf_counters.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <stdint.h>
+#include "perf_counters.h"
+
+#ifdef __linux__
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+static std::atomic<long> profiles(0);
+
+//Group of counters of the calling thread for the profile with serial
+struct ThreadGroup {
+    long serial;
+    int  thread;
+    int  leader;
+    int  fd[PerfProfile::nevents];
+};
+static thread_local ThreadGroup local = {0, 0, -1, {-1, -1, -1, -1, -1}};
+
+static double now(void){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef __linux__
+//Counter of this thread in any CPU (user space only so that it works with
+//kernel.perf_event_paranoid = 2); the leader starts the group disabled
+static int openEvent(uint32_t type, uint64_t config, int leader){
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size           = sizeof(attr);
+    attr.type           = type;
+    attr.config         = config;
+    attr.disabled       = leader < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                          PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, leader, 0);
+}
+#endif
+
+PerfProfile::PerfProfile(void) : serial(++profiles), counting(false){
+#ifdef __linux__
+    status = "perf_event_open";
+#else
+    status = "Hardware counters are only read on Linux";
+#endif
+}
+
+PerfProfile::~PerfProfile(void){
+#ifdef __linux__
+    for (size_t g = 0; g < groups.size(); g++){
+        for (int e = 0; e < nevents; e++){
+            if (groups[g].fd[e] >= 0){
+                close(groups[g].fd[e]);
+            }
+        }
+    }
+#endif
+}
+
+int PerfProfile::thread(void){
+
+    if (local.serial == serial){
+        return local.thread;
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    Group group;
+    group.leader = -1;
+    for (int e = 0; e < nevents; e++){
+        group.fd[e] = -1;
+    }
+
+#ifdef __linux__
+    //Counters not supported (e.g. in virtual machines) are left out
+    const uint64_t l1 = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    const uint32_t type[nevents]   = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                      PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+    const uint64_t config[nevents] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, l1,
+                                      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    group.fd[0] = openEvent(type[0], config[0], -1);
+    if (group.fd[0] >= 0){
+        group.leader = group.fd[0];
+        for (int e = 1; e < nevents; e++){
+            group.fd[e] = openEvent(type[e], config[e], group.leader);
+        }
+        ioctl(group.leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(group.leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    } else if (!counting){
+        status = std::string("Hardware counters unavailable (") + strerror(errno) +
+                 "); see /proc/sys/kernel/perf_event_paranoid";
+    }
+    counting = counting || group.leader >= 0;
+#endif
+
+    groups.push_back(group);
+    local.serial = serial;
+    local.thread = groups.size() - 1;
+    local.leader = group.leader;
+    for (int e = 0; e < nevents; e++){
+        local.fd[e] = group.fd[e];
+    }
+    return local.thread;
+}
+
+//Time and counters of the group of the calling thread
+static void readGroup(PerfProfile::Reading& reading){
+
+    reading.enabled = reading.running = 0.0;
+    for (int e = 0; e < PerfProfile::nevents; e++){
+        reading.values[e] = 0.0;
+    }
+
+#ifdef __linux__
+    //Number of counters, times enabled and running and the counters in the
+    //order they were added to the group
+    if (local.leader >= 0){
+        uint64_t buffer[3 + PerfProfile::nevents];
+        if (::read(local.leader, buffer, sizeof(buffer)) > 0){
+            reading.enabled = buffer[1];
+            reading.running = buffer[2];
+            int k = 0;
+            for (int e = 0; e < PerfProfile::nevents && k < (int) buffer[0]; e++){
+                if (local.fd[e] >= 0){
+                    reading.values[e] = buffer[3 + k++];
+                }
+            }
+        }
+    }
+#endif
+
+    reading.seconds = now();
+}
+
+void PerfProfile::read(Reading& reading){
+    reading.thread = thread();
+    readGroup(reading);
+}
+
+void PerfProfile::add(const char* phase, const Reading& start){
+
+    Reading end;
+    end.thread = start.thread;
+    readGroup(end);
+
+    //Counters scaled by the time they ran when the kernel multiplexes them
+    const double running = end.running - start.running;
+    const double scale   = running > 0 ? (end.enabled - start.enabled)/running : 0.0;
+
+    std::lock_guard<std::mutex> guard(lock);
+    Phase* p = NULL;
+    for (size_t k = 0; k < phases.size() && p == NULL; k++){
+        if (phases[k].thread == start.thread && strcmp(phases[k].name, phase) == 0){
+            p = &phases[k];
+        }
+    }
+    if (p == NULL){
+        Phase added;
+        added.name    = phase;
+        added.thread  = start.thread;
+        added.calls   = added.seconds = 0.0;
+        added.counted = local.leader >= 0;
+        for (int e = 0; e < nevents; e++){
+            added.values[e] = 0.0;
+        }
+        phases.push_back(added);
+        p = &phases.back();
+    }
+    p->calls   += 1.0;
+    p->seconds += end.seconds - start.seconds;
+    for (int e = 0; e < nevents; e++){
+        p->values[e] += scale*(end.values[e] - start.values[e]);
+    }
+}
+
+List PerfProfile::report(void) const {
+
+    std::lock_guard<std::mutex> guard(lock);
+    const int n = phases.size();
+    CharacterVector PHASE(n);
+    IntegerVector   THREAD(n);
+    NumericVector   CALLS(n), SECONDS(n), CYCLES(n), INSTRUCTIONS(n), IPC(n), L1(n), LLC(n), BRANCH(n);
+    for (int k = 0; k < n; k++){
+        const Phase& p = phases[k];
+        const Group& g = groups[p.thread];
+        PHASE(k)   = p.name;
+        THREAD(k)  = p.thread;
+        CALLS(k)   = p.calls;
+        SECONDS(k) = p.seconds;
+        CYCLES(k)       = p.counted && g.fd[0] >= 0 ? p.values[0] : NA_REAL;
+        INSTRUCTIONS(k) = p.counted && g.fd[1] >= 0 ? p.values[1] : NA_REAL;
+        L1(k)           = p.counted && g.fd[2] >= 0 ? p.values[2] : NA_REAL;
+        LLC(k)          = p.counted && g.fd[3] >= 0 ? p.values[3] : NA_REAL;
+        BRANCH(k)       = p.counted && g.fd[4] >= 0 ? p.values[4] : NA_REAL;
+        IPC(k)          = p.counted && g.fd[1] >= 0 && p.values[0] > 0 ? p.values[1]/p.values[0] : NA_REAL;
+    }
+
+    DataFrame table = DataFrame::create(Named("Phase") = PHASE, Named("Thread") = THREAD,
+                                        Named("Calls") = CALLS, Named("Seconds") = SECONDS,
+                                        Named("Cycles") = CYCLES, Named("Instructions") = INSTRUCTIONS,
+                                        Named("IPC") = IPC, Named("L1_Misses") = L1,
+                                        Named("LLC_Misses") = LLC, Named("Branch_Misses") = BRANCH,
+                                        Named("stringsAsFactors") = false);
+    return List::create(Named("Phases") = table, Named("Counters") = status);
+}
@@ -0,0 +1,141 @@
+//
+//  perf_counters.h
+//
+//  Time and hardware counters (cycles, instructions, L1 data and last level
+//  cache misses, branch misses) of the phases of the models by thread, read
+//  with perf_event_open on Linux when control$perf is TRUE. Each thread opens
+//  one group of counters the first time it measures a phase and a PerfScope
+//  adds the difference between its start and end to the phase; phases nested
+//  in others are also counted in them. Counters are scaled when the kernel
+//  multiplexes them. When they cannot be opened (other systems, containers,
+//  kernel.perf_event_paranoid) only the time is measured and the report says
+//  why. Without a profile (the default) a PerfScope only checks a pointer.
+//
+//  Example:
+//      std::shared_ptr<PerfProfile> perf = std::make_shared<PerfProfile>();
+//      for (int i = 1; i <= nsims; i++){
+//          PerfScope derivatives(perf.get(), "Derivatives");
+//          ...
+//          derivatives.stop();
+//      }
+//      result.push_back(perf->report(), "Performance");
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef perf_counters_h
+#define perf_counters_h
+
+#include <mutex>
+#include <string>
+#include <vector>
+#include <Rcpp.h>
+using namespace Rcpp;
+
+class PerfProfile {
+public:
+
+    //Cycles, instructions, L1 data misses, last level cache misses, branch misses
+    static const int nevents = 5;
+
+    //Time and counters of the calling thread at the start of a phase
+    struct Reading {
+        double seconds;
+        double enabled, running;
+        double values[nevents];
+        int    thread;
+    };
+
+    PerfProfile(void);
+    ~PerfProfile(void);
+
+    void read(Reading& reading);
+
+    //Adds the time and counters since start to phase (a string literal)
+    void add(const char* phase, const Reading& start);
+
+    //Phase, thread, calls, seconds and counters (NA if not counted) and
+    //whether the counters were available
+    List report(void) const;
+
+    PerfProfile(const PerfProfile&) = delete;
+    PerfProfile& operator=(const PerfProfile&) = delete;
+
+private:
+
+    //Counters of the calling thread (opened on its first reading)
+    int thread(void);
+
+    struct Phase {
+        const char* name;
+        int    thread;
+        double calls, seconds;
+        double values[nevents];
+        bool   counted;
+    };
+
+    //Leader and counters of the group of each thread (-1 if not opened)
+    struct Group {
+        int leader;
+        int fd[nevents];
+    };
+
+    long serial;
+    bool counting;              //Whether the counters of a thread were opened
+    mutable std::mutex lock;
+    std::vector<Phase> phases;
+    std::vector<Group> groups;
+    std::string        status;
+};
+
+//Measures its lifetime as phase of profile (nothing if profile is NULL)
+class PerfScope {
+public:
+    PerfScope(PerfProfile* profile, const char* phase) : profile(profile), phase(phase){
+        if (profile != NULL){
+            profile->read(start);
+        }
+    }
+    ~PerfScope(void){
+        stop();
+    }
+    
+    //Ends the phase before the end of the scope
+    void stop(void){
+        if (profile != NULL){
+            profile->add(phase, start);
+            profile = NULL;
+        }
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfProfile*         profile;
+    const char*          phase;
+    PerfProfile::Reading start;
+};
+
+#endif /* perf_counters_h */
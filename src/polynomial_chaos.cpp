@@ -0,0 +1,488 @@
+//
+//  polynomial_chaos.cpp
+//
+//  Polynomial chaos expansions and their sparse fit (see polynomial_chaos.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "polynomial_chaos.h"
+
+//Polynomials
+//--------------------------------------------------------------------------------
+void orthonormalPolynomials(PolynomialFamily family, double x, int degree, double* values){
+    
+    //Three term recurrences of Legendre P_k and Hermite He_k
+    values[0] = 1.0;
+    if (degree >= 1){
+        values[1] = x;
+    }
+    for (int k = 1; k < degree; k++){
+        if (family == LEGENDRE){
+            values[k + 1] = ((2.0*k + 1.0)*x*values[k] - k*values[k - 1])/(k + 1.0);
+        } else {
+            values[k + 1] = x*values[k] - k*values[k - 1];
+        }
+    }
+    
+    //Norms under the uniform on [-1, 1] (1/(2k + 1)) and the standard normal (k!)
+    double factorial = 1.0;
+    for (int k = 1; k <= degree; k++){
+        if (family == LEGENDRE){
+            values[k] *= sqrt(2.0*k + 1.0);
+        } else {
+            factorial *= k;
+            values[k] /= sqrt(factorial);
+        }
+    }
+}
+
+void gaussQuadrature(PolynomialFamily family, int n, std::vector<double>& nodes,
+                     std::vector<double>& weights){
+    
+    nodes.assign(n, 0.0);
+    weights.assign(n, 0.0);
+    
+    //Newton iterations from the usual first guesses of the roots (symmetric
+    //so only half of them are searched)
+    std::vector<double> roots(n);
+    double z = 0.0;
+    for (int i = 0; i < (n + 1)/2; i++){
+        
+        if (family == LEGENDRE){
+            z = cos(M_PI*(i + 0.75)/(n + 0.5));
+        } else if (i == 0){
+            z = sqrt(2.0*n + 1.0) - 1.85575*pow(2.0*n + 1.0, -0.16667);
+        } else if (i == 1){
+            z -= 1.14*pow(n, 0.426)/z;
+        } else if (i == 2){
+            z = 1.86*z - 0.86*roots[0];
+        } else if (i == 3){
+            z = 1.91*z - 0.91*roots[1];
+        } else {
+            z = 2.0*z - roots[i - 2];
+        }
+        
+        //Legendre P_n or the physicists' Hermite H_n normalized to unit L2 norm
+        //under exp(-z^2) (Numerical Recipes, gauleg and gauher)
+        double derivative = 0.0;
+        for (int iter = 0; iter < 100; iter++){
+            double p1 = (family == LEGENDRE) ? 1.0 : pow(M_PI, -0.25);
+            double p2 = 0.0;
+            for (int k = 0; k < n; k++){
+                double p3 = p2;
+                p2 = p1;
+                if (family == LEGENDRE){
+                    p1 = ((2.0*k + 1.0)*z*p2 - k*p3)/(k + 1.0);
+                } else {
+                    p1 = z*sqrt(2.0/(k + 1.0))*p2 - sqrt(k/(k + 1.0))*p3;
+                }
+            }
+            if (family == LEGENDRE){
+                derivative = n*(z*p1 - p2)/(z*z - 1.0);
+            } else {
+                derivative = sqrt(2.0*n)*p2;
+            }
+            double previous = z;
+            z = previous - p1/derivative;
+            if (fabs(z - previous) <= 1.e-15*std::max(1.0, fabs(z))){
+                break;
+            }
+        }
+        
+        roots[i] = z;
+        
+        //Weights of the probability measures: dx/2 on [-1, 1] and the standard
+        //normal (x = sqrt(2) z for Hermite)
+        if (family == LEGENDRE){
+            nodes[i]          = -z;
+            nodes[n - 1 - i]  = z;
+            weights[i]        = 1.0/((1.0 - z*z)*derivative*derivative);
+        } else {
+            nodes[i]          = z*M_SQRT2;
+            nodes[n - 1 - i]  = -z*M_SQRT2;
+            weights[i]        = 2.0/(derivative*derivative)/sqrt(M_PI);
+        }
+        weights[n - 1 - i] = weights[i];
+    }
+    
+    //Hermite nodes were found from the largest
+    if (family == HERMITE){
+        std::reverse(nodes.begin(), nodes.end());
+        std::reverse(weights.begin(), weights.end());
+    }
+}
+
+//Basis
+//--------------------------------------------------------------------------------
+static void hyperbolicTerms(int dim, int degree, double q, std::vector<int>& term, int position,
+                            double norm, int total, std::vector<int>& indices){
+    if (position == dim){
+        if (total == 0){
+            return;
+        }
+        indices.insert(indices.end(), term.begin(), term.end());
+        return;
+    }
+    for (int a = 0; a <= degree - total; a++){
+        double next = norm + pow((double) a, q);
+        if (a > 0 && pow(next, 1.0/q) > degree + 1.e-10){
+            break;
+        }
+        term[position] = a;
+        hyperbolicTerms(dim, degree, q, term, position + 1, next, total + a, indices);
+    }
+    term[position] = 0;
+}
+
+std::vector<int> hyperbolicBasis(int dim, int degree, double q){
+    
+    //Constant first and then the terms of each total degree
+    std::vector<int> indices(dim, 0);
+    std::vector<int> term(dim, 0);
+    for (int total = 1; total <= degree; total++){
+        std::vector<int> candidates;
+        hyperbolicTerms(dim, degree, q, term, 0, 0.0, 0, candidates);
+        for (size_t k = 0; k < candidates.size(); k += dim){
+            int sum = 0;
+            for (int j = 0; j < dim; j++){
+                sum += candidates[k + j];
+            }
+            if (sum == total){
+                indices.insert(indices.end(), candidates.begin() + k, candidates.begin() + k + dim);
+            }
+        }
+    }
+    
+    return indices;
+}
+
+PolynomialChaos::PolynomialChaos(const std::vector<PolynomialFamily>& families,
+                                 const std::vector<int>& indices)
+: families(families), indices(indices), degree(0) {
+    for (size_t k = 0; k < indices.size(); k++){
+        degree = std::max(degree, indices[k]);
+    }
+}
+
+void PolynomialChaos::basis(const double* xi, double* values) const {
+    
+    //Polynomials of each variable once and then their products
+    int d = dim();
+    std::vector<double> polynomials(d*(degree + 1));
+    for (int j = 0; j < d; j++){
+        orthonormalPolynomials(families[j], xi[j], degree, &polynomials[j*(degree + 1)]);
+    }
+    
+    int P = terms();
+    for (int a = 0; a < P; a++){
+        double value = 1.0;
+        for (int j = 0; j < d; j++){
+            value *= polynomials[j*(degree + 1) + indices[a*d + j]];
+        }
+        values[a] = value;
+    }
+}
+
+std::vector<double> PolynomialChaos::design(const double* points, int n) const {
+    
+    int d = dim();
+    int P = terms();
+    std::vector<double> Psi(n*P);
+    std::vector<double> xi(d);
+    std::vector<double> values(P);
+    for (int i = 0; i < n; i++){
+        for (int j = 0; j < d; j++){
+            xi[j] = points[i + j*n];
+        }
+        basis(&xi[0], &values[0]);
+        for (int a = 0; a < P; a++){
+            Psi[i + a*n] = values[a];
+        }
+    }
+    
+    return Psi;
+}
+
+//Fit
+//--------------------------------------------------------------------------------
+
+//Cholesky factor (lower, in place) of the k x k matrix A; false if it is not
+//positive definite
+static bool cholesky(std::vector<double>& A, int k){
+    for (int j = 0; j < k; j++){
+        double diagonal = A[j + j*k];
+        for (int l = 0; l < j; l++){
+            diagonal -= A[j + l*k]*A[j + l*k];
+        }
+        if (!(diagonal > 1.e-12*std::max(1.0, fabs(A[j + j*k])))){
+            return false;
+        }
+        A[j + j*k] = sqrt(diagonal);
+        for (int i = j + 1; i < k; i++){
+            double value = A[i + j*k];
+            for (int l = 0; l < j; l++){
+                value -= A[i + l*k]*A[j + l*k];
+            }
+            A[i + j*k] = value/A[j + j*k];
+        }
+    }
+    return true;
+}
+
+//Solves L L' x = b in place with the factor of cholesky
+static void choleskySolve(const std::vector<double>& L, int k, double* b){
+    for (int i = 0; i < k; i++){
+        for (int l = 0; l < i; l++){
+            b[i] -= L[i + l*k]*b[l];
+        }
+        b[i] /= L[i + i*k];
+    }
+    for (int i = k - 1; i >= 0; i--){
+        for (int l = i + 1; l < k; l++){
+            b[i] -= L[l + i*k]*b[l];
+        }
+        b[i] /= L[i + i*k];
+    }
+}
+
+ChaosFit leastSquares(const std::vector<double>& Psi, int n, const std::vector<int>& terms,
+                      const double* y){
+    
+    ChaosFit fit;
+    fit.terms = terms;
+    fit.loo   = std::numeric_limits<double>::infinity();
+    int k = terms.size();
+    if (k == 0 || n <= k){
+        return fit;
+    }
+    
+    //Normal equations M c = Psi' y of the columns of the terms
+    std::vector<double> M(k*k);
+    std::vector<double> c(k);
+    for (int a = 0; a < k; a++){
+        const double* column = &Psi[terms[a]*n];
+        for (int b = 0; b <= a; b++){
+            const double* other = &Psi[terms[b]*n];
+            double value = 0.0;
+            for (int i = 0; i < n; i++){
+                value += column[i]*other[i];
+            }
+            M[a + b*k] = value;
+            M[b + a*k] = value;
+        }
+        double value = 0.0;
+        for (int i = 0; i < n; i++){
+            value += column[i]*y[i];
+        }
+        c[a] = value;
+    }
+    if (!cholesky(M, k)){
+        return fit;
+    }
+    choleskySolve(M, k, &c[0]);
+    fit.coefficients = c;
+    
+    //Leave one out residuals (y_i - f(x_i))/(1 - h_i) with the leverages h_i
+    //of the rows, trace of M^-1 and variance of y
+    double mean = 0.0;
+    for (int i = 0; i < n; i++){
+        mean += y[i];
+    }
+    mean /= n;
+    
+    std::vector<double> row(k);
+    double loo = 0.0, variance = 0.0, trace = 0.0;
+    for (int i = 0; i < n; i++){
+        double fitted = 0.0;
+        for (int a = 0; a < k; a++){
+            row[a]  = Psi[i + terms[a]*n];
+            fitted += c[a]*row[a];
+        }
+        std::vector<double> solved(row);
+        choleskySolve(M, k, &solved[0]);
+        double leverage = 0.0;
+        for (int a = 0; a < k; a++){
+            leverage += row[a]*solved[a];
+        }
+        double residual = (y[i] - fitted)/std::max(1.0 - leverage, 1.e-10);
+        loo      += residual*residual;
+        variance += (y[i] - mean)*(y[i] - mean);
+    }
+    for (int a = 0; a < k; a++){
+        std::vector<double> unit(k, 0.0);
+        unit[a] = 1.0;
+        choleskySolve(M, k, &unit[0]);
+        trace += unit[a];
+    }
+    
+    //Correction for the number of terms T = n/(n - k) (1 + tr((Psi'Psi/n)^-1)/n)
+    double correction = n/((double) (n - k))*(1.0 + trace);
+    fit.loo = (variance > 0) ? correction*loo/variance : 0.0;
+    
+    return fit;
+}
+
+ChaosFit hybridLar(const std::vector<double>& Psi, int n, int P, const double* y){
+    
+    //Centred and scaled columns of the terms other than the constant
+    std::vector<int>    candidates;
+    std::vector<double> X;
+    for (int a = 1; a < P; a++){
+        const double* column = &Psi[a*n];
+        double mean = 0.0, norm = 0.0;
+        for (int i = 0; i < n; i++){
+            mean += column[i];
+        }
+        mean /= n;
+        for (int i = 0; i < n; i++){
+            norm += (column[i] - mean)*(column[i] - mean);
+        }
+        if (norm <= 1.e-12*n){
+            continue;
+        }
+        norm = sqrt(norm);
+        candidates.push_back(a);
+        for (int i = 0; i < n; i++){
+            X.push_back((column[i] - mean)/norm);
+        }
+    }
+    int p = candidates.size();
+    
+    std::vector<double> residual(y, y + n);
+    double mean = 0.0;
+    for (int i = 0; i < n; i++){
+        mean += y[i];
+    }
+    mean /= n;
+    for (int i = 0; i < n; i++){
+        residual[i] -= mean;
+    }
+    
+    //Least angle regression (Efron et al. 2004): the terms enter the active
+    //set in order of their correlation with the residual and the fit moves in
+    //the direction equiangular to the active terms
+    std::vector<int>  path;
+    std::vector<bool> active(p, false);
+    std::vector<double> correlation(p);
+    int steps = std::min(p, n - 2);
+    for (int step = 0; step < steps; step++){
+        
+        double largest = 0.0;
+        int entering   = -1;
+        for (int j = 0; j < p; j++){
+            double value = 0.0;
+            for (int i = 0; i < n; i++){
+                value += X[i + j*n]*residual[i];
+            }
+            correlation[j] = value;
+            if (!active[j] && fabs(value) > largest){
+                largest  = fabs(value);
+                entering = j;
+            }
+        }
+        for (size_t a = 0; a < path.size(); a++){
+            largest = std::max(largest, fabs(correlation[path[a]]));
+        }
+        if (entering < 0 || largest <= 1.e-14){
+            break;
+        }
+        active[entering] = true;
+        path.push_back(entering);
+        
+        //Gram matrix of the signed active columns and w = G^-1 1 / sqrt(1' G^-1 1)
+        int k = path.size();
+        std::vector<double> G(k*k);
+        std::vector<double> sign(k);
+        for (int a = 0; a < k; a++){
+            sign[a] = (correlation[path[a]] >= 0) ? 1.0 : -1.0;
+        }
+        for (int a = 0; a < k; a++){
+            for (int b = 0; b <= a; b++){
+                double value = 0.0;
+                for (int i = 0; i < n; i++){
+                    value += X[i + path[a]*n]*X[i + path[b]*n];
+                }
+                G[a + b*k] = G[b + a*k] = sign[a]*sign[b]*value;
+            }
+        }
+        if (!cholesky(G, k)){
+            path.pop_back();
+            break;
+        }
+        std::vector<double> w(k, 1.0);
+        choleskySolve(G, k, &w[0]);
+        double A = 0.0;
+        for (int a = 0; a < k; a++){
+            A += w[a];
+        }
+        A = 1.0/sqrt(A);
+        
+        //Equiangular direction u and the step until another term is as
+        //correlated (the last step goes to the least squares fit)
+        std::vector<double> u(n, 0.0);
+        for (int a = 0; a < k; a++){
+            double weight = A*w[a]*sign[a];
+            for (int i = 0; i < n; i++){
+                u[i] += weight*X[i + path[a]*n];
+            }
+        }
+        double C     = fabs(correlation[path[0]]);
+        double gamma = C/A;
+        for (int j = 0; j < p; j++){
+            if (active[j]){
+                continue;
+            }
+            double a = 0.0;
+            for (int i = 0; i < n; i++){
+                a += X[i + j*n]*u[i];
+            }
+            double candidates[2] = {(C - correlation[j])/(A - a), (C + correlation[j])/(A + a)};
+            for (int m = 0; m < 2; m++){
+                if (candidates[m] > 1.e-14 && candidates[m] < gamma){
+                    gamma = candidates[m];
+                }
+            }
+        }
+        for (int i = 0; i < n; i++){
+            residual[i] -= gamma*u[i];
+        }
+    }
+    
+    //Least squares on the constant and each leading set of the path
+    std::vector<int> terms(1, 0);
+    ChaosFit best = leastSquares(Psi, n, terms, y);
+    for (size_t a = 0; a < path.size(); a++){
+        terms.push_back(candidates[path[a]]);
+        ChaosFit fit = leastSquares(Psi, n, terms, y);
+        if (fit.loo < best.loo){
+            best = fit;
+        }
+    }
+    
+    return best;
+}
@@ -0,0 +1,113 @@
+//
+//  polynomial_chaos.h
+//
+//  Polynomial chaos expansions of model outcomes in uncertain parameters:
+//  y(x) ~ sum_a c_a psi_a(xi) where xi are the parameters standardized
+//  (uniform on [-1, 1] or standard normal) and psi_a are products of the
+//  orthonormal polynomials of each parameter (Legendre or Hermite). The
+//  coefficients are fitted from model runs by projection on a quadrature
+//  or by least squares on the terms chosen by least angle regression
+//  (hybrid LAR of Blatman and Sudret, 2011).
+//
+//  Example:
+//      PolynomialChaos pce(families, hyperbolicBasis(dim, 3, 0.75));
+//      std::vector<double> Psi = pce.design(points, n);
+//      ChaosFit fit = hybridLar(Psi, n, pce.terms(), y);
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Blatman, Géraud, and Bruno Sudret. 2011. “Adaptive Sparse Polynomial Chaos Expansion Based on
+//      Least Angle Regression.” Journal of Computational Physics 230 (6). Elsevier: 2345–67.
+//
+//  Efron, Bradley, Trevor Hastie, Iain Johnstone, and Robert Tibshirani. 2004. “Least Angle
+//      Regression.” The Annals of Statistics 32 (2): 407–99.
+//
+//  Sudret, Bruno. 2008. “Global Sensitivity Analysis Using Polynomial Chaos Expansions.”
+//      Reliability Engineering & System Safety 93 (7). Elsevier: 964–79.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef polynomial_chaos_h
+#define polynomial_chaos_h
+
+#include <vector>
+
+enum PolynomialFamily {LEGENDRE = 0, HERMITE = 1};
+
+//Orthonormal polynomials of degree 0 to degree at x: Legendre for uniform
+//variables on [-1, 1] and (probabilists') Hermite for standard normal ones
+void orthonormalPolynomials(PolynomialFamily family, double x, int degree, double* values);
+
+//Gauss quadrature of n nodes for the distribution of the family (the
+//weights add up to 1)
+void gaussQuadrature(PolynomialFamily family, int n, std::vector<double>& nodes,
+                     std::vector<double>& weights);
+
+//Degrees of each variable (dim per term) of the terms whose q-norm
+//(sum a_i^q)^(1/q) is at most degree; q = 1 is the total degree basis and
+//smaller q drop interactions of high order. The constant term is first.
+std::vector<int> hyperbolicBasis(int dim, int degree, double q);
+
+//Basis of an expansion
+//--------------------------------------------------------------------------------
+class PolynomialChaos {
+public:
+    
+    PolynomialChaos(const std::vector<PolynomialFamily>& families, const std::vector<int>& indices);
+    
+    int dim(void) const { return families.size(); }
+    int terms(void) const { return indices.size()/families.size(); }
+    
+    //Values of the terms at the standardized point xi (dim values)
+    void basis(const double* xi, double* values) const;
+    
+    //Values of the terms (n x terms by column) at the n points (n x dim by column)
+    std::vector<double> design(const double* points, int n) const;
+    
+private:
+    std::vector<PolynomialFamily> families;
+    std::vector<int> indices;
+    int degree;           //Largest degree of a variable
+};
+
+//Sparse fit: terms (from 0) with their coefficients and the relative leave
+//one out error corrected for the number of terms
+//--------------------------------------------------------------------------------
+struct ChaosFit {
+    std::vector<int>    terms;
+    std::vector<double> coefficients;
+    double              loo;
+};
+
+//Least squares on the terms (Psi is n x P by column)
+ChaosFit leastSquares(const std::vector<double>& Psi, int n, const std::vector<int>& terms,
+                      const double* y);
+
+//Least angle regression orders the terms (after the constant) by how they
+//enter the path; least squares on each leading set of the path keeps the one
+//with the smallest corrected leave one out error
+ChaosFit hybridLar(const std::vector<double>& Psi, int n, int P, const double* y);
+
+#endif /* polynomial_chaos_h */
@@ -0,0 +1,137 @@
+//
+//  polynomial_chaos_wrapper.cpp
+//
+//  Polynomial chaos surrogates of the models (see polynomial_chaos.h).
+//
+//  Input:
+//  dim             .-  Number of parameters.
+//  degree          .-  Largest total degree of the terms.
+//  q               .-  q-norm of the hyperbolic truncation (0 < q <= 1).
+//  family          .-  0 for Legendre (uniform) and 1 for Hermite (normal).
+//  n               .-  Number of quadrature nodes.
+//  points          .-  Standardized parameters (one row per point).
+//  families        .-  Family of each parameter.
+//  basis           .-  Degree of each parameter (columns) in each term (rows).
+//  threads         .-  Threads evaluating the points.
+//  Psi             .-  Values of the terms at the points (one row per point).
+//  y               .-  Outcome at each point.
+//  sparse          .-  Hybrid least angle regression instead of least squares.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include <algorithm>
+#include "polynomial_chaos.h"
+#include "thread_governor.h"
+using namespace Rcpp;
+
+// [[Rcpp::export]]
+IntegerMatrix pce_basis_wrapper(int dim, int degree, double q){
+    std::vector<int> indices = hyperbolicBasis(dim, degree, q);
+    int P = indices.size()/dim;
+    IntegerMatrix basis(P, dim);
+    for (int a = 0; a < P; a++){
+        for (int j = 0; j < dim; j++){
+            basis(a, j) = indices[a*dim + j];
+        }
+    }
+    return basis;
+}
+
+// [[Rcpp::export]]
+List pce_quadrature_wrapper(int family, int n){
+    std::vector<double> nodes, weights;
+    gaussQuadrature((PolynomialFamily) family, n, nodes, weights);
+    return List::create(Named("nodes") = wrap(nodes), Named("weights") = wrap(weights));
+}
+
+// [[Rcpp::export]]
+NumericMatrix pce_design_wrapper(NumericMatrix points, IntegerVector families, IntegerMatrix basis,
+                                 int threads){
+    
+    int n = points.nrow();
+    int d = points.ncol();
+    std::vector<PolynomialFamily> family(d);
+    for (int j = 0; j < d; j++){
+        family[j] = (PolynomialFamily) families(j);
+    }
+    std::vector<int> indices(basis.nrow()*d);
+    for (int a = 0; a < basis.nrow(); a++){
+        for (int j = 0; j < d; j++){
+            indices[a*d + j] = basis(a, j);
+        }
+    }
+    PolynomialChaos pce(family, indices);
+    
+    //Blocks of points evaluated by the threads (no R objects are touched by them)
+    int P = pce.terms();
+    NumericMatrix Psi(n, P);
+    const double* x = points.begin();
+    double* values  = Psi.begin();
+    int size        = 1024;
+    int nblocks     = (n + size - 1)/size;
+    parallelFor(nblocks, std::max(1, std::min(threadBudget(threads), nblocks)), [&](int block){
+        int first = block*size;
+        int last  = std::min(n, first + size);
+        std::vector<double> xi(d), row(P);
+        for (int i = first; i < last; i++){
+            for (int j = 0; j < d; j++){
+                xi[j] = x[i + j*n];
+            }
+            pce.basis(&xi[0], &row[0]);
+            for (int a = 0; a < P; a++){
+                values[i + a*n] = row[a];
+            }
+        }
+    });
+    
+    return Psi;
+}
+
+// [[Rcpp::export]]
+List pce_fit_wrapper(NumericMatrix Psi, NumericVector y, bool sparse){
+    
+    int n = Psi.nrow();
+    int P = Psi.ncol();
+    std::vector<double> design(Psi.begin(), Psi.end());
+    ChaosFit fit;
+    if (sparse){
+        fit = hybridLar(design, n, P, y.begin());
+    } else {
+        std::vector<int> terms(P);
+        for (int a = 0; a < P; a++){
+            terms[a] = a;
+        }
+        fit = leastSquares(design, n, terms, y.begin());
+    }
+    
+    //Terms from 1 for R
+    IntegerVector terms(fit.terms.size());
+    for (size_t a = 0; a < fit.terms.size(); a++){
+        terms[a] = fit.terms[a] + 1;
+    }
+    return List::create(Named("terms")        = terms,
+                        Named("coefficients") = wrap(fit.coefficients),
+                        Named("loo")          = fit.loo);
+}
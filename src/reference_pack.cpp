@@ -0,0 +1,153 @@
+//
+//  reference_pack.cpp
+//
+//  Reference tables of fat free mass (FFM) and fat mass (FM) by sex, BMI
+//  category and age for the children model. The tables shipped with the
+//  package (mean and median values) are in inst/extdata/reference and are
+//  loaded from R (see R/reference_pack.R).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+// References:
+//
+//  Ellis, Kenneth J, Roman J Shypailo, Steven A Abrams, and William W Wong. 2000. “The Reference Child and Adolescent Models of Body Composition: A Contemporary Comparison.”
+//      Annals of the New York Academy of Sciences 904 (1). Wiley Online Library: 374–82.
+//
+//  Fomon, Samuel J, Ferdinand Haschke, Ekhard E Ziegler, and Steven E Nelson. 1982. “Body Composition of Reference Children from Birth to Age 10 Years.” The American Journal of
+//      Clinical Nutrition 35 (5). Am Soc Nutrition: 1169–75.
+//
+//  Haschke, F. 1989. “Body Composition During Adolescence.” Body Composition Measurements in Infants and Children.
+//      Ross Laboratories Columbus, OH, 76–83.
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <cmath>
+#include <stdexcept>
+#include <stdint.h>
+#include "reference_pack.h"
+
+ReferencePack::ReferencePack(const std::vector<double>& input_ages, const std::vector<double>& input_FFM,
+                             const std::vector<double>& input_FM){
+    
+    ages = input_ages;
+    
+    if (ages.empty()){
+        throw std::invalid_argument("ReferencePack: the table has no ages.");
+    }
+    for (std::size_t j = 1; j < ages.size(); j++){
+        if (!(ages[j] > ages[j - 1])){
+            throw std::invalid_argument("ReferencePack: ages must be increasing.");
+        }
+    }
+    if (input_FFM.size() != nsex*ncat*ages.size() || input_FM.size() != nsex*ncat*ages.size()){
+        throw std::invalid_argument("ReferencePack: one FFM and FM per sex, BMI category and age is needed.");
+    }
+    
+    //Each series padded to a multiple of 8 doubles (64 bytes)
+    const int nages   = ages.size();
+    const int nseries = nsex*ncat;
+    stride  = ((2*nages + 7)/8)*8;
+    storage = std::vector<double>(stride*nseries + 8, 0.0);
+    
+    //First 64 byte boundary inside storage
+    uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+    values = storage.data() + ((64 - address % 64) % 64)/sizeof(double);
+    
+    for (int s = 0; s < nseries; s++){
+        for (int j = 0; j < nages; j++){
+            values[s*stride + 2*j]     = input_FFM[s*nages + j];
+            values[s*stride + 2*j + 1] = input_FM[s*nages + j];
+        }
+    }
+}
+
+double ReferencePack::lookup(int sex, int bmiCat, double age, int which) const {
+    
+    if (sex < 0 || sex >= nsex || bmiCat < 1 || bmiCat > ncat || std::isnan(age)){
+        return NAN;
+    }
+    
+    const double* series = values + (sex*ncat + bmiCat - 1)*stride;
+    const int nages      = ages.size();
+    
+    if (age <= ages[0]){
+        return series[which];
+    }
+    if (age >= ages[nages - 1]){
+        return series[2*(nages - 1) + which];
+    }
+    
+    //ages[jmin] <= age < ages[jmin + 1]
+    int jmin    = std::upper_bound(ages.begin(), ages.end(), age) - ages.begin() - 1;
+    double diff = (age - ages[jmin])/(ages[jmin + 1] - ages[jmin]);
+    return series[2*jmin + which] + diff*(series[2*(jmin + 1) + which] - series[2*jmin + which]);
+}
+
+double ReferencePack::FFM(int sex, int bmiCat, double age) const {
+    return lookup(sex, bmiCat, age, 0);
+}
+
+double ReferencePack::FM(int sex, int bmiCat, double age) const {
+    return lookup(sex, bmiCat, age, 1);
+}
+
+//Registry
+//--------------------------------------------------------------------------------
+static std::mutex& registryMutex(void){
+    static std::mutex m;
+    return m;
+}
+
+static std::map<std::string, std::shared_ptr<const ReferencePack> >& registry(void){
+    static std::map<std::string, std::shared_ptr<const ReferencePack> > packs;
+    return packs;
+}
+
+void registerReferencePack(const std::string& name, std::shared_ptr<const ReferencePack> pack){
+    std::lock_guard<std::mutex> lock(registryMutex());
+    if (registry().count(name) > 0){
+        throw std::invalid_argument("Reference pack '" + name + "' is already loaded.");
+    }
+    registry()[name] = pack;
+}
+
+std::shared_ptr<const ReferencePack> findReferencePack(const std::string& name){
+    std::lock_guard<std::mutex> lock(registryMutex());
+    std::map<std::string, std::shared_ptr<const ReferencePack> >::const_iterator it = registry().find(name);
+    if (it == registry().end()){
+        return std::shared_ptr<const ReferencePack>();
+    }
+    return it->second;
+}
+
+std::vector<std::string> referencePackNames(void){
+    std::lock_guard<std::mutex> lock(registryMutex());
+    std::vector<std::string> names;
+    std::map<std::string, std::shared_ptr<const ReferencePack> >::const_iterator it;
+    for (it = registry().begin(); it != registry().end(); ++it){
+        names.push_back(it->first);
+    }
+    return names;
+}
@@ -0,0 +1,80 @@
+//
+//  reference_pack.h
+//
+//  Reference tables of fat free mass (FFM) and fat mass (FM) by sex, BMI
+//  category and age for the children model. Packs are loaded once per
+//  process under a name and shared (read only) by every Child and thread.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef reference_pack_h
+#define reference_pack_h
+
+#include <memory>
+#include <string>
+#include <vector>
+
+//Reference values of one pack. Each (sex, BMI category) series is stored as
+//(FFM, FM) pairs by age starting on a 64 byte boundary, so the FFM and FM of
+//an age share a cache line and a series never shares one with the next. The
+//two ages of an interpolation are in the same line unless the lower one is
+//the last of its line (index 3 mod 4), and the search reads the ages grid.
+//--------------------------------------------------------------------------------
+class ReferencePack {
+public:
+    
+    static const int nsex = 2;      //0 = "male"; 1 = "female"
+    static const int ncat = 4;      //1 to 4: Underweight, normal, overweight and obese
+    
+    //ages is the grid of ages (yrs), non empty and increasing; FFM and FM are
+    //indexed as [(sex*ncat + bmiCat - 1)*ages.size() + age]. Throws
+    //std::invalid_argument otherwise.
+    ReferencePack(const std::vector<double>& ages, const std::vector<double>& FFM,
+                  const std::vector<double>& FM);
+    
+    //Linear interpolation in age; constant outside of the age grid
+    double FFM(int sex, int bmiCat, double age) const;
+    double FM(int sex, int bmiCat, double age) const;
+    
+    //values points inside storage so packs are never copied
+    ReferencePack(const ReferencePack&) = delete;
+    ReferencePack& operator=(const ReferencePack&) = delete;
+    
+private:
+    std::vector<double> ages;
+    std::vector<double> storage;    //Raw memory; values starts aligned inside
+    double*             values;
+    int                 stride;     //Doubles per series (padded to a cache line)
+    
+    double lookup(int sex, int bmiCat, double age, int which) const;
+};
+
+//Process wide registry of packs. A name is registered once: registering it
+//again throws std::invalid_argument so a pack is never silently replaced.
+void registerReferencePack(const std::string& name, std::shared_ptr<const ReferencePack> pack);
+std::shared_ptr<const ReferencePack> findReferencePack(const std::string& name);
+std::vector<std::string> referencePackNames(void);
+
+#endif /* reference_pack_h */
@@ -0,0 +1,84 @@
+//
+//  reference_pack_wrapper.cpp
+//
+//  Functions to load reference packs of fat free mass and fat mass for the
+//  children model from R.
+//
+//  Input:
+//  name            .-  Name under which the pack is registered
+//  sex             .-  Either 1 = "female" or 0 = "male"
+//  bmiCat          .-  BMI category from 1 to 4
+//  age             .-  Age (yrs)
+//  FFM             .-  Reference fat free mass (kg)
+//  FM              .-  Reference fat mass (kg)
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include <algorithm>
+#include "reference_pack.h"
+using namespace Rcpp;
+
+// [[Rcpp::export]]
+void reference_pack_register_wrapper(std::string name, NumericVector sex, NumericVector bmiCat,
+                                     NumericVector age, NumericVector FFM, NumericVector FM){
+    
+    //Grid of ages
+    std::vector<double> ages(age.begin(), age.end());
+    std::sort(ages.begin(), ages.end());
+    ages.erase(std::unique(ages.begin(), ages.end()), ages.end());
+    
+    //Every sex, BMI category and age must be in the table
+    const int nages   = ages.size();
+    const int nseries = ReferencePack::nsex*ReferencePack::ncat;
+    std::vector<double> ffm(nseries*nages, NA_REAL);
+    std::vector<double> fm(nseries*nages, NA_REAL);
+    
+    for (int i = 0; i < age.size(); i++){
+        int j = std::lower_bound(ages.begin(), ages.end(), age(i)) - ages.begin();
+        int s = ((int) sex(i))*ReferencePack::ncat + ((int) bmiCat(i)) - 1;
+        if (s < 0 || s >= nseries){
+            stop("Invalid sex or bmiCat in reference pack '" + name + "'.");
+        }
+        if (!ISNAN(ffm[s*nages + j])){
+            stop("Reference pack '" + name + "' has more than one row for a sex, bmiCat and age.");
+        }
+        ffm[s*nages + j] = FFM(i);
+        fm[s*nages + j]  = FM(i);
+    }
+    
+    for (int k = 0; k < nseries*nages; k++){
+        if (ISNAN(ffm[k]) || ISNAN(fm[k])){
+            stop("Reference pack '" + name + "' must have values for every sex, bmiCat and age.");
+        }
+    }
+    
+    registerReferencePack(name, std::shared_ptr<const ReferencePack>(new ReferencePack(ages, ffm, fm)));
+}
+
+// [[Rcpp::export]]
+CharacterVector reference_pack_names_wrapper(){
+    std::vector<std::string> names = referencePackNames();
+    return CharacterVector(names.begin(), names.end());
+}
@@ -0,0 +1,128 @@
+//
+//  run_monitor.cpp
+//
+//  Monitor of a model that runs in a background process (see run_monitor.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include "run_monitor.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+//Steps written start after a header of one cache line and the values after
+//the steps written rounded up to a cache line
+static std::size_t roundUp(std::size_t bytes){
+    return (bytes + 63)/64*64;
+}
+
+RunMonitor::RunMonitor(const std::vector<std::string>& variables, int capacity) :
+    names(variables), capacity(std::max(capacity, 1)){
+
+    const std::size_t nvar   = names.size();
+    const std::size_t offset = 64 + roundUp(nvar*sizeof(std::atomic<int>));
+    bytes = offset + 2*nvar*this->capacity*sizeof(double);
+
+    //Shared with the processes forked later (private memory without fork)
+#ifndef _WIN32
+    base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED){
+        throw std::runtime_error("Unable to allocate " + std::to_string(bytes) +
+                                 " bytes of shared memory for the monitor");
+    }
+#else
+    base = ::operator new(bytes);
+#endif
+
+    header = new (base) Header();
+    header->cancelled.store(0);
+    header->nind.store(0);
+    header->nsteps.store(0);
+    written = reinterpret_cast<std::atomic<int>*>(static_cast<char*>(base) + 64);
+    for (std::size_t v = 0; v < nvar; v++){
+        new (&written[v]) std::atomic<int>(0);
+    }
+    values = reinterpret_cast<double*>(static_cast<char*>(base) + offset);
+}
+
+RunMonitor::~RunMonitor(void){
+#ifndef _WIN32
+    munmap(base, bytes);
+#else
+    ::operator delete(base);
+#endif
+}
+
+void RunMonitor::start(int nind, int nsteps){
+    header->nind.store(nind);
+    header->nsteps.store(std::min(nsteps, capacity), std::memory_order_release);
+}
+
+void RunMonitor::record(const char* name, int step, const double* x, int n){
+
+    if (step >= capacity){
+        return;
+    }
+    for (std::size_t v = 0; v < names.size(); v++){
+        if (names[v].compare(name) != 0){
+            continue;
+        }
+
+        //Welford's algorithm as the aggregates of the recorder
+        double m = 0.0, m2 = 0.0;
+        for (int i = 0; i < n; i++){
+            double d = x[i] - m;
+            m  += d/(i + 1.0);
+            m2 += d*(x[i] - m);
+        }
+        values[(2*v)*capacity + step]     = m;
+        values[(2*v + 1)*capacity + step] = n > 1 ? sqrt(m2/(n - 1.0)) : NAN;
+        written[v].store(step + 1, std::memory_order_release);
+    }
+}
+
+void RunMonitor::cancel(void){
+    header->cancelled.store(1);
+}
+
+bool RunMonitor::cancelled(void) const {
+    return header->cancelled.load(std::memory_order_relaxed) != 0;
+}
+
+int RunMonitor::individuals(void) const {
+    return header->nind.load();
+}
+
+int RunMonitor::steps(void) const {
+    return header->nsteps.load(std::memory_order_acquire);
+}
+
+int RunMonitor::done(int variable) const {
+    return written[variable].load(std::memory_order_acquire);
+}
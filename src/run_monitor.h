@@ -0,0 +1,100 @@
+//
+//  run_monitor.h
+//
+//  Progress, partial aggregates and cancellation of a model that runs in a
+//  background process (see bw_async in R). The monitor is created before
+//  the process is forked in a shared anonymous mapping so the run writes
+//  the mean and standard deviation of each variable at each step and the
+//  session that started it reads them without touching R objects of the
+//  run. Each variable publishes the number of steps written after writing
+//  them, and the run stops at its next step once it is cancelled.
+//
+//  Example:
+//      RunMonitor monitor(variables, capacity);     //Session, before the fork
+//      monitor.start(nind, nsims + 1);              //Run
+//      monitor.record("Body_Weight", i, bw, nind);
+//      if (monitor.cancelled()) stop("The run was cancelled.");
+//      int done = monitor.done(0);                  //Session
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef run_monitor_h
+#define run_monitor_h
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class RunMonitor {
+public:
+
+    //Room for the aggregates of capacity steps of each variable
+    RunMonitor(const std::vector<std::string>& variables, int capacity);
+    ~RunMonitor(void);
+
+    //Individuals and steps of the run
+    void start(int nind, int nsteps);
+
+    //Mean and SD of the n values of name at step (steps of a variable in order)
+    void record(const char* name, int step, const double* x, int n);
+
+    void cancel(void);
+    bool cancelled(void) const;
+
+    const std::vector<std::string>& variables(void) const { return names; }
+
+    //Individuals and steps of the run (0 until it starts)
+    int individuals(void) const;
+    int steps(void) const;
+
+    //Steps of variable written
+    int done(int variable) const;
+
+    double mean(int variable, int step) const { return values[(2*variable)*capacity + step]; }
+    double sd(int variable, int step) const { return values[(2*variable + 1)*capacity + step]; }
+
+    RunMonitor(const RunMonitor&) = delete;
+    RunMonitor& operator=(const RunMonitor&) = delete;
+
+private:
+
+    //State shared with the run (at the start of the mapping)
+    struct Header {
+        std::atomic<int> cancelled;
+        std::atomic<int> nind;
+        std::atomic<int> nsteps;
+    };
+
+    std::vector<std::string> names;
+    int                      capacity;
+    void*                    base;          //Mapping (header, steps written and values)
+    std::size_t              bytes;
+    Header*                  header;
+    std::atomic<int>*        written;
+    double*                  values;
+};
+
+#endif /* run_monitor_h */
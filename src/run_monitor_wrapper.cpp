@@ -0,0 +1,102 @@
+//
+//  run_monitor_wrapper.cpp
+//
+//  Monitor of the runs of bw_async (see run_monitor.h). It is created in the
+//  session before the run is forked and read there while the run goes on.
+//
+//  Input:
+//  variables       .-  Variables whose mean and SD are published at each step.
+//  capacity        .-  Maximum number of steps of the run.
+//  monitor         .-  Monitor created by run_monitor_wrapper.
+//  dt              .-  Days between steps.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <Rcpp.h>
+#include "run_monitor.h"
+using namespace Rcpp;
+
+static std::shared_ptr<RunMonitor> monitorOf(SEXP monitor){
+    XPtr<std::shared_ptr<RunMonitor> > ptr(monitor);
+    return *ptr;
+}
+
+//Steps written of every variable
+static int stepsDone(const RunMonitor& monitor){
+    int done = monitor.steps();
+    for (size_t v = 0; v < monitor.variables().size(); v++){
+        done = std::min(done, monitor.done(v));
+    }
+    return done;
+}
+
+// [[Rcpp::export]]
+SEXP run_monitor_wrapper(CharacterVector variables, int capacity){
+    std::vector<std::string> names;
+    for (int v = 0; v < variables.size(); v++){
+        names.push_back(as<std::string>(variables(v)));
+    }
+    std::shared_ptr<RunMonitor> monitor = std::make_shared<RunMonitor>(names, capacity);
+    return XPtr<std::shared_ptr<RunMonitor> >(new std::shared_ptr<RunMonitor>(monitor), true);
+}
+
+// [[Rcpp::export]]
+bool run_monitor_cancel_wrapper(SEXP monitor){
+    monitorOf(monitor)->cancel();
+    return true;
+}
+
+// [[Rcpp::export]]
+List run_monitor_progress_wrapper(SEXP monitor){
+    std::shared_ptr<RunMonitor> m = monitorOf(monitor);
+    return List::create(Named("N") = m->individuals(), Named("Steps") = m->steps(),
+                        Named("Done") = stepsDone(*m), Named("Cancelled") = m->cancelled());
+}
+
+// [[Rcpp::export]]
+List run_monitor_aggregates_wrapper(SEXP monitor, double dt){
+    
+    //Same format as the aggregates of control$retain for the steps written
+    std::shared_ptr<RunMonitor> m = monitorOf(monitor);
+    const int done = stepsDone(*m);
+    NumericVector TIME(done);
+    for (int i = 0; i < done; i++){
+        TIME(i) = i*dt;
+    }
+    
+    List result;
+    result.push_back(TIME, "Time");
+    result.push_back(m->individuals(), "N");
+    for (size_t v = 0; v < m->variables().size(); v++){
+        NumericVector MEAN(done), SD(done);
+        for (int i = 0; i < done; i++){
+            MEAN(i) = m->mean(v, i);
+            SD(i)   = ISNAN(m->sd(v, i)) ? NA_REAL : m->sd(v, i);
+        }
+        result.push_back(List::create(Named("Mean") = MEAN, Named("SD") = SD), m->variables()[v]);
+    }
+    
+    return result;
+}
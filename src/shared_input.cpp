@@ -0,0 +1,190 @@
+//
+//  shared_input.cpp
+//
+//  ALTREP class of the shared inputs (see shared_input.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <Rversion.h>
+#include "shared_input.h"
+
+#if R_VERSION >= R_Version(3, 6, 0) && !defined(_WIN32)
+#define BW_SHARED_INPUT
+#include <R_ext/Altrep.h>
+#endif
+
+#ifdef BW_SHARED_INPUT
+
+static R_altrep_class_t sharedReal;
+
+//data1 is an external pointer to the segment; data2 is not used
+//--------------------------------------------------------------------------------
+static SharedSegment* segmentOf(SEXP x){
+    std::shared_ptr<SharedSegment>* segment =
+        static_cast<std::shared_ptr<SharedSegment>*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+    return segment->get();
+}
+
+static void finalizeSegment(SEXP ptr){
+    std::shared_ptr<SharedSegment>* segment =
+        static_cast<std::shared_ptr<SharedSegment>*>(R_ExternalPtrAddr(ptr));
+    if (segment != NULL){
+        delete segment;
+        R_ClearExternalPtr(ptr);
+    }
+}
+
+//Methods of the class
+//--------------------------------------------------------------------------------
+static R_xlen_t sharedLength(SEXP x){
+    return segmentOf(x)->size();
+}
+
+//R never writes on the values (the object is not mutable and its copies are
+//ordinary vectors); the mapping is private so a write would stay in this process
+static void* sharedDataptr(SEXP x, Rboolean /* writeable */){
+    return segmentOf(x)->data();
+}
+
+static const void* sharedDataptrOrNull(SEXP x){
+    return segmentOf(x)->data();
+}
+
+static double sharedElt(SEXP x, R_xlen_t i){
+    return segmentOf(x)->data()[i];
+}
+
+static R_xlen_t sharedGetRegion(SEXP x, R_xlen_t start, R_xlen_t size, double* buffer){
+    const R_xlen_t n = std::min(size, (R_xlen_t) segmentOf(x)->size() - start);
+    if (n > 0){
+        memcpy(buffer, segmentOf(x)->data() + start, n*sizeof(double));
+    }
+    return std::max(n, (R_xlen_t) 0);
+}
+
+//Serialized as an ordinary vector (saveRDS keeps the values). With
+//options(bw.share.attach = TRUE) the state is the name of the segment, its
+//length and its nonce (as text, a double does not hold 64 bits) so that
+//workers of the same machine map it again instead of receiving the values
+//(the attributes are written by R)
+static SEXP sharedSerializedState(SEXP x){
+    if (Rf_asLogical(Rf_GetOption1(Rf_install("bw.share.attach"))) != TRUE){
+        return NULL;
+    }
+    SharedSegment* segment = segmentOf(x);
+    SEXP state = PROTECT(Rf_allocVector(STRSXP, 3));
+    SET_STRING_ELT(state, 0, Rf_mkChar(segment->name().c_str()));
+    SET_STRING_ELT(state, 1, Rf_mkChar(std::to_string(segment->size()).c_str()));
+    SET_STRING_ELT(state, 2, Rf_mkChar(std::to_string(segment->nonce()).c_str()));
+    UNPROTECT(1);
+    return state;
+}
+
+//The segment must still be the one that was serialized: names are reused
+//once it is removed
+static SEXP sharedUnserialize(SEXP /* cls */, SEXP state){
+    char message[512] = "";
+    SEXP x = R_NilValue;
+    try {
+        const std::string name = CHAR(STRING_ELT(state, 0));
+        std::shared_ptr<SharedSegment> segment = SharedSegment::attach(name);
+        if (std::to_string(segment->size()) != CHAR(STRING_ELT(state, 1)) ||
+            std::to_string(segment->nonce()) != CHAR(STRING_ELT(state, 2))){
+            throw std::runtime_error("Shared memory segment " + name + " was replaced.");
+        }
+        x = sharedInput(segment);
+    } catch (std::exception& e){
+        snprintf(message, sizeof(message), "%s The shared input was serialized with "
+                 "options(bw.share.attach = TRUE), which only keeps the name of its segment: "
+                 "keep it in the publishing process until the workers read it.", e.what());
+    }
+    if (message[0] != '\0'){
+        Rf_error("%s", message);
+    }
+    return x;
+}
+
+static Rboolean sharedInspect(SEXP x, int /* pre */, int /* deep */, int /* pvec */,
+                              void (* /* inspect_subtree */)(SEXP, int, int, int)){
+    Rprintf(" bw shared input %s (%.0f values%s)\n", segmentOf(x)->name().c_str(),
+            (double) segmentOf(x)->size(), segmentOf(x)->publisher() ? ", published here" : "");
+    return TRUE;
+}
+
+void registerSharedInput(DllInfo* dll){
+    sharedReal = R_make_altreal_class("bw_shared_real", "bw", dll);
+    R_set_altrep_Length_method(sharedReal, sharedLength);
+    R_set_altrep_Serialized_state_method(sharedReal, sharedSerializedState);
+    R_set_altrep_Unserialize_method(sharedReal, sharedUnserialize);
+    R_set_altrep_Inspect_method(sharedReal, sharedInspect);
+    R_set_altvec_Dataptr_method(sharedReal, sharedDataptr);
+    R_set_altvec_Dataptr_or_null_method(sharedReal, sharedDataptrOrNull);
+    R_set_altreal_Elt_method(sharedReal, sharedElt);
+    R_set_altreal_Get_region_method(sharedReal, sharedGetRegion);
+}
+
+bool sharedInputAvailable(void){
+    return SharedSegment::available();
+}
+
+SEXP sharedInput(const std::shared_ptr<SharedSegment>& segment){
+    SEXP ptr = PROTECT(R_MakeExternalPtr(new std::shared_ptr<SharedSegment>(segment),
+                                         R_NilValue, R_NilValue));
+    R_RegisterCFinalizerEx(ptr, finalizeSegment, TRUE);
+    SEXP x = R_new_altrep(sharedReal, ptr, R_NilValue);
+    MARK_NOT_MUTABLE(x);
+    UNPROTECT(1);
+    return x;
+}
+
+std::shared_ptr<SharedSegment> sharedSegmentOf(SEXP x){
+    if (!ALTREP(x) || !R_altrep_inherits(x, sharedReal)){
+        return std::shared_ptr<SharedSegment>();
+    }
+    return *static_cast<std::shared_ptr<SharedSegment>*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+#else
+
+//Before R 3.6 and on Windows inputs are not shared
+void registerSharedInput(DllInfo* /* dll */){
+}
+
+bool sharedInputAvailable(void){
+    return false;
+}
+
+SEXP sharedInput(const std::shared_ptr<SharedSegment>& /* segment */){
+    throw std::runtime_error("Shared inputs need R 3.6 or later on a POSIX system");
+}
+
+std::shared_ptr<SharedSegment> sharedSegmentOf(SEXP /* x */){
+    return std::shared_ptr<SharedSegment>();
+}
+
+#endif
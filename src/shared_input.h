@@ -0,0 +1,55 @@
+//
+//  shared_input.h
+//
+//  Numeric vectors and matrices of R whose values are those of a shared
+//  memory segment (see shared_segment.h). They are ALTREP objects (R 3.6 or
+//  later): the models and R read the segment directly. They are serialized
+//  (saveRDS, parallel::clusterExport) as ordinary vectors unless the option
+//  bw.share.attach is TRUE; then only the name of the segment is written and
+//  the receiving process of the same machine maps it again.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef shared_input_h
+#define shared_input_h
+
+#include <memory>
+#include <Rcpp.h>
+#include "shared_segment.h"
+using namespace Rcpp;
+
+//Registers the ALTREP class (when the package is loaded)
+void registerSharedInput(DllInfo* dll);
+
+//Whether shared inputs are available in this system and version of R
+bool sharedInputAvailable(void);
+
+//Numeric vector of R with the values of the segment (no attributes)
+SEXP sharedInput(const std::shared_ptr<SharedSegment>& segment);
+
+//Segment of x (empty if x is not a shared input)
+std::shared_ptr<SharedSegment> sharedSegmentOf(SEXP x);
+
+#endif /* shared_input_h */
@@ -0,0 +1,83 @@
+//
+//  shared_input_wrapper.cpp
+//
+//  Publishes numeric inputs of the models in shared memory and maps them in
+//  other processes (see shared_input.h).
+//
+//  Input:
+//  x               .-  Numeric vector or matrix (double).
+//  name            .-  Name of a published segment.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include "shared_input.h"
+using namespace Rcpp;
+
+// [[Rcpp::init]]
+void shared_input_init(DllInfo* dll){
+    registerSharedInput(dll);
+}
+
+// [[Rcpp::export]]
+bool shared_input_available_wrapper(){
+    return sharedInputAvailable();
+}
+
+//Copy of x in a new segment with the attributes of x
+// [[Rcpp::export]]
+SEXP shared_input_wrapper(NumericVector x){
+    SEXP shared = PROTECT(sharedInput(SharedSegment::publish(x.begin(), x.size())));
+    SHALLOW_DUPLICATE_ATTRIB(shared, x);
+    UNPROTECT(1);
+    return shared;
+}
+
+// [[Rcpp::export]]
+SEXP shared_input_attach_wrapper(std::string name){
+    return sharedInput(SharedSegment::attach(name));
+}
+
+//Name of the segment of x, its size (bytes) and whether this process
+//published it; NULL if x is not shared
+// [[Rcpp::export]]
+SEXP shared_input_info_wrapper(SEXP x){
+    std::shared_ptr<SharedSegment> segment = sharedSegmentOf(x);
+    if (!segment){
+        return R_NilValue;
+    }
+    return List::create(Named("name")      = segment->name(),
+                        Named("bytes")     = (double) segment->size()*sizeof(double),
+                        Named("publisher") = segment->publisher());
+}
+
+// [[Rcpp::export]]
+bool shared_input_release_wrapper(SEXP x){
+    std::shared_ptr<SharedSegment> segment = sharedSegmentOf(x);
+    if (!segment || !segment->publisher()){
+        return false;
+    }
+    segment->release();
+    return true;
+}
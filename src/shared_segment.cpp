@@ -0,0 +1,211 @@
+//
+//  shared_segment.cpp
+//
+//  Values in POSIX shared memory (see shared_segment.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <stdint.h>
+#include "shared_segment.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+//The values start after a header of one cache line
+//--------------------------------------------------------------------------------
+struct SegmentHeader {
+    char     magic[8];
+    uint64_t n;
+    uint64_t nonce;
+};
+static const char        segmentMagic[8] = "bwshm02";
+static const std::size_t headerBytes     = 64;
+
+#ifndef _WIN32
+
+//Segments are files of /dev/shm on Linux (where shm_open may need librt)
+//and shm_open names elsewhere
+static int openSegment(const std::string& name, int flags, mode_t mode){
+#ifdef __linux__
+    return open(("/dev/shm" + name).c_str(), flags, mode);
+#else
+    return shm_open(name.c_str(), flags, mode);
+#endif
+}
+
+static int unlinkSegment(const std::string& name){
+#ifdef __linux__
+    return unlink(("/dev/shm" + name).c_str());
+#else
+    return shm_unlink(name.c_str());
+#endif
+}
+
+static std::atomic<int> published(0);
+
+bool SharedSegment::available(void){
+    return true;
+}
+
+std::shared_ptr<SharedSegment> SharedSegment::publish(const double* values, std::size_t n){
+    
+    //Short names (macOS allows 31 characters) unique in the machine
+    const std::size_t bytes = headerBytes + n*sizeof(double);
+    std::string name;
+    int fd = -1;
+    while (fd < 0){
+        name = "/bw-" + std::to_string((long) getpid()) + "-" + std::to_string(published++);
+        fd   = openSegment(name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+        if (fd < 0 && errno != EEXIST){
+            throw std::runtime_error("Unable to create shared memory segment " + name +
+                                     ": " + strerror(errno));
+        }
+    }
+    
+    //Written once through a shared mapping and then read only
+    void* base = MAP_FAILED;
+    if (ftruncate(fd, bytes) == 0){
+        base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    if (base == MAP_FAILED){
+        const std::string reason = strerror(errno);
+        close(fd);
+        unlinkSegment(name);
+        throw std::runtime_error("Unable to allocate " + std::to_string(bytes) +
+                                 " bytes of shared memory (" + reason + ")");
+    }
+    std::random_device device;
+    SegmentHeader* header = static_cast<SegmentHeader*>(base);
+    memcpy(header->magic, segmentMagic, sizeof(segmentMagic));
+    header->n     = n;
+    header->nonce = ((uint64_t(device()) << 32) | device()) ^
+                    (uint64_t) std::chrono::system_clock::now().time_since_epoch().count();
+    const uint64_t nonce = header->nonce;
+    if (n > 0){
+        memcpy(static_cast<char*>(base) + headerBytes, values, n*sizeof(double));
+    }
+    fchmod(fd, S_IRUSR);
+    munmap(base, bytes);
+    
+    //The publisher reads it as the other processes do
+    base = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED){
+        unlinkSegment(name);
+        throw std::runtime_error("Unable to map shared memory segment " + name);
+    }
+    
+    return std::shared_ptr<SharedSegment>(new SharedSegment(name, base, bytes, n, nonce,
+                                                            (long) getpid()));
+}
+
+std::shared_ptr<SharedSegment> SharedSegment::attach(const std::string& name){
+    
+    const int fd = openSegment(name, O_RDONLY, 0);
+    if (fd < 0){
+        throw std::runtime_error("Shared memory segment " + name + " not found. It must be "
+                                 "published by a process of this machine that keeps it.");
+    }
+    struct stat info;
+    void* base = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && (std::size_t) info.st_size >= headerBytes){
+        base = mmap(NULL, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED){
+        throw std::runtime_error("Unable to map shared memory segment " + name);
+    }
+    
+    const SegmentHeader* header = static_cast<const SegmentHeader*>(base);
+    const std::size_t bytes = info.st_size;
+    if (memcmp(header->magic, segmentMagic, sizeof(segmentMagic)) != 0 ||
+        headerBytes + header->n*sizeof(double) != bytes){
+        munmap(base, bytes);
+        throw std::runtime_error(name + " is not a shared memory segment of bw");
+    }
+    
+    return std::shared_ptr<SharedSegment>(new SharedSegment(name, base, bytes, header->n,
+                                                            header->nonce, 0));
+}
+
+SharedSegment::SharedSegment(const std::string& id, void* base, std::size_t bytes,
+                             std::size_t n, uint64_t key, long owner) :
+    id(id), base(base), bytes(bytes), n(n),
+    values(reinterpret_cast<double*>(static_cast<char*>(base) + headerBytes)), key(key),
+    owner(owner){
+}
+
+SharedSegment::~SharedSegment(void){
+    release();
+    munmap(base, bytes);
+}
+
+//Forked children share the object of their parent but not its segment
+bool SharedSegment::publisher(void) const {
+    return owner != 0 && owner == (long) getpid();
+}
+
+void SharedSegment::release(void){
+    if (publisher()){
+        unlinkSegment(id);
+        owner = 0;
+    }
+}
+
+#else
+
+//No POSIX shared memory on Windows
+bool SharedSegment::available(void){
+    return false;
+}
+
+std::shared_ptr<SharedSegment> SharedSegment::publish(const double* values, std::size_t n){
+    throw std::runtime_error("Shared memory is not available on Windows");
+}
+
+std::shared_ptr<SharedSegment> SharedSegment::attach(const std::string& name){
+    throw std::runtime_error("Shared memory is not available on Windows");
+}
+
+SharedSegment::~SharedSegment(void){
+}
+
+bool SharedSegment::publisher(void) const {
+    return false;
+}
+
+void SharedSegment::release(void){
+}
+
+#endif
@@ -0,0 +1,93 @@
+//
+//  shared_segment.h
+//
+//  Values published in POSIX shared memory (a file of /dev/shm on Linux) so
+//  that the other processes of the machine (parallel::mclapply children,
+//  workers of parallel::makeCluster) read them by name instead of holding a
+//  copy each. Other processes map the segment privately: they share its
+//  pages and a write, if any, only changes their own copy.
+//
+//  Example:
+//      std::shared_ptr<SharedSegment> s = SharedSegment::publish(x, n);
+//      //In another process
+//      std::shared_ptr<SharedSegment> t = SharedSegment::attach(s->name());
+//      double y = t->data()[0];
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef shared_segment_h
+#define shared_segment_h
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <stdint.h>
+
+class SharedSegment {
+public:
+    
+    //Copies the n values to a new segment with a unique name. The name is
+    //removed when the segment of the publishing process is destroyed (or
+    //released); processes that already mapped it keep their view.
+    static std::shared_ptr<SharedSegment> publish(const double* values, std::size_t n);
+    
+    //Maps the segment published with that name (throws std::runtime_error if
+    //there is none in this machine)
+    static std::shared_ptr<SharedSegment> attach(const std::string& name);
+    
+    //Whether segments can be published in this system
+    static bool available(void);
+    
+    ~SharedSegment(void);
+    
+    const std::string& name(void) const { return id; }
+    std::size_t size(void) const { return n; }
+    double* data(void) const { return values; }
+    
+    //Random number written by the publisher: names are reused once a segment
+    //is removed, the nonce tells a segment from a later one with its name
+    uint64_t nonce(void) const { return key; }
+    bool publisher(void) const;
+    
+    //Removes the name so that no other process can attach it
+    void release(void);
+    
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+    
+private:
+    SharedSegment(const std::string& id, void* base, std::size_t bytes, std::size_t n,
+                  uint64_t key, long owner);
+    
+    std::string id;
+    void*       base;               //Mapping (header and values)
+    std::size_t bytes;
+    std::size_t n;
+    double*     values;
+    uint64_t    key;
+    long        owner;              //Process that publishes it (0 if attached)
+};
+
+#endif /* shared_segment_h */
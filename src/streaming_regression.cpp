@@ -0,0 +1,315 @@
+//
+//  streaming_regression.cpp
+//
+//  Weighted regressions accumulated step by step (see streaming_regression.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include "streaming_regression.h"
+#include "thread_governor.h"
+
+//Steps accumulated at once (the buffer keeps n values of each)
+static const int REGRESSION_BLOCK = 16;
+
+StreamingRegression::StreamingRegression(const double* input_X, const double* input_w,
+                                         const int* input_strata, const int* input_cluster,
+                                         int input_n, int input_p, int input_nsteps,
+                                         int input_noutcomes, bool input_change, int input_threads)
+: n(input_n), p(input_p), nsteps(input_nsteps), noutcomes(input_noutcomes), nstrata(1),
+  nclusters(0), npsu(input_n), threads(std::max(1, input_threads)), change(input_change),
+  singular(false), block(REGRESSION_BLOCK) {
+    
+    //Individuals in the order of their clusters
+    order.resize(n);
+    for (int i = 0; i < n; i++){
+        order[i] = i;
+        if (input_strata){
+            nstrata = std::max(nstrata, input_strata[i] + 1);
+        }
+        if (input_cluster){
+            nclusters = std::max(nclusters, input_cluster[i] + 1);
+        }
+    }
+    if (input_cluster){
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b){
+            return input_cluster[a] < input_cluster[b];
+        });
+    }
+    
+    X.resize(n*p);
+    w.resize(n);
+    strata.assign(n, 0);
+    cluster.assign(n, -1);
+    for (int r = 0; r < n; r++){
+        int i = order[r];
+        for (int j = 0; j < p; j++){
+            X[r*p + j] = input_X[i + j*n];
+        }
+        w[r] = input_w[i];
+        if (input_strata){
+            strata[r] = input_strata[i];
+        }
+        if (input_cluster){
+            cluster[r] = input_cluster[i];
+        }
+    }
+    
+    //Primary sampling units (clusters or individuals) of each stratum
+    psuInStratum.assign(nstrata, 0);
+    npsu = 0;
+    for (int r = 0; r < n; r++){
+        if (nclusters == 0 || r == 0 || cluster[r] != cluster[r - 1]){
+            psuInStratum[strata[r]]++;
+            npsu++;
+        }
+    }
+    
+    //X'WX and its inverse by the Cholesky factor
+    std::vector<double> L(p*p, 0.0);
+    for (int r = 0; r < n; r++){
+        const double* x = &X[r*p];
+        for (int j = 0; j < p; j++){
+            for (int k = 0; k < p; k++){
+                L[j*p + k] += w[r]*x[j]*x[k];
+            }
+        }
+    }
+    for (int j = 0; j < p && !singular; j++){
+        double d     = L[j*p + j];
+        double scale = std::max(1.0, fabs(d));
+        for (int l = 0; l < j; l++){
+            d -= L[j*p + l]*L[j*p + l];
+        }
+        if (!(d > 1.e-12*scale)){
+            singular = true;
+            break;
+        }
+        L[j*p + j] = sqrt(d);
+        for (int i = j + 1; i < p; i++){
+            double v = L[i*p + j];
+            for (int l = 0; l < j; l++){
+                v -= L[i*p + l]*L[j*p + l];
+            }
+            L[i*p + j] = v/L[j*p + j];
+        }
+    }
+    inverse.assign(p*p, 0.0);
+    if (!singular){
+        for (int c = 0; c < p; c++){
+            std::vector<double> e(p, 0.0);
+            e[c] = 1.0;
+            for (int i = 0; i < p; i++){
+                for (int l = 0; l < i; l++){
+                    e[i] -= L[i*p + l]*e[l];
+                }
+                e[i] /= L[i*p + i];
+            }
+            for (int i = p - 1; i >= 0; i--){
+                for (int l = i + 1; l < p; l++){
+                    e[i] -= L[l*p + i]*e[l];
+                }
+                e[i] /= L[i*p + i];
+            }
+            for (int i = 0; i < p; i++){
+                inverse[i*p + c] = e[i];
+            }
+        }
+    }
+    
+    coefficients.assign(noutcomes, std::vector<double>(nsteps*p, 0.0));
+    meat.assign(noutcomes, std::vector<double>(nsteps*p*p, 0.0));
+    baseline.assign(noutcomes, std::vector<double>());
+    buffer.assign(noutcomes, std::vector<double>());
+    pending.assign(noutcomes, std::vector<int>());
+}
+
+void StreamingRegression::add(int outcome, int step, const double* y){
+    
+    std::vector<double>& base = baseline[outcome];
+    if (change && base.empty()){
+        base.assign(y, y + n);
+    }
+    
+    std::vector<double>& values = buffer[outcome];
+    if (values.empty()){
+        values.resize(n*block);
+    }
+    double* column = &values[pending[outcome].size()*n];
+    for (int r = 0; r < n; r++){
+        column[r] = change ? y[order[r]] - base[order[r]] : y[order[r]];
+    }
+    pending[outcome].push_back(step);
+    
+    if ((int) pending[outcome].size() == block){
+        flush(outcome);
+    }
+}
+
+void StreamingRegression::flush(int outcome){
+    
+    const std::vector<int>& steps = pending[outcome];
+    const int b = steps.size();
+    if (b == 0){
+        return;
+    }
+    const double* values = &buffer[outcome][0];
+    
+    //Ranges of individuals of each thread (whole clusters)
+    int nchunks = std::max(1, std::min(threads, n/256));
+    std::vector<int> bounds(nchunks + 1, n);
+    for (int c = 0; c < nchunks; c++){
+        int r = (int) ((long long) n*c/nchunks);
+        while (nclusters > 0 && r > 0 && r < n && cluster[r] == cluster[r - 1]){
+            r++;
+        }
+        bounds[c] = r;
+    }
+    std::vector<std::vector<double> > parts(nchunks);
+    
+    //X'Wy of each step and its coefficients
+    parallelFor(nchunks, threads, [&](int c){
+        std::vector<double>& XtWy = parts[c];
+        XtWy.assign(b*p, 0.0);
+        for (int r = bounds[c]; r < bounds[c + 1]; r++){
+            const double* x = &X[r*p];
+            for (int t = 0; t < b; t++){
+                double wy = w[r]*values[t*n + r];
+                for (int j = 0; j < p; j++){
+                    XtWy[t*p + j] += wy*x[j];
+                }
+            }
+        }
+    });
+    std::vector<double> beta(b*p, 0.0);
+    for (int t = 0; t < b; t++){
+        for (int j = 0; j < p; j++){
+            double XtWy = 0.0;
+            for (int c = 0; c < nchunks; c++){
+                XtWy += parts[c][t*p + j];
+            }
+            for (int k = 0; k < p; k++){
+                beta[t*p + k] += inverse[k*p + j]*XtWy;
+            }
+        }
+    }
+    
+    //Scores s = sum w x e of each cluster (or individual): sum of s s' (upper
+    //triangle) and of s of each stratum and step
+    const int size = p*p + p;
+    parallelFor(nchunks, threads, [&](int c){
+        std::vector<double>& part = parts[c];
+        part.assign(nstrata*b*size, 0.0);
+        std::vector<double> s(b*p, 0.0);
+        for (int r = bounds[c]; r < bounds[c + 1]; r++){
+            const double* x = &X[r*p];
+            for (int t = 0; t < b; t++){
+                double e = values[t*n + r];
+                for (int j = 0; j < p; j++){
+                    e -= x[j]*beta[t*p + j];
+                }
+                for (int j = 0; j < p; j++){
+                    s[t*p + j] += w[r]*e*x[j];
+                }
+            }
+            
+            //Last individual of its sampling unit
+            if (nclusters > 0 && r + 1 < n && cluster[r + 1] == cluster[r]){
+                continue;
+            }
+            for (int t = 0; t < b; t++){
+                double* SS      = &part[(strata[r]*b + t)*size];
+                double* S       = SS + p*p;
+                const double* u = &s[t*p];
+                for (int j = 0; j < p; j++){
+                    S[j] += u[j];
+                    for (int k = j; k < p; k++){
+                        SS[j*p + k] += u[j]*u[k];
+                    }
+                }
+            }
+            std::fill(s.begin(), s.end(), 0.0);
+        }
+    });
+    
+    //Sandwich meat sum_h nh/(nh - 1) (sum s s' - S S'/nh)
+    for (int t = 0; t < b; t++){
+        double* M = &meat[outcome][steps[t]*p*p];
+        std::fill(M, M + p*p, 0.0);
+        for (int h = 0; h < nstrata; h++){
+            double nh = psuInStratum[h];
+            if (nh < 2){
+                continue;
+            }
+            std::vector<double> total(size, 0.0);
+            for (int c = 0; c < nchunks; c++){
+                const double* part = &parts[c][(h*b + t)*size];
+                for (int k = 0; k < size; k++){
+                    total[k] += part[k];
+                }
+            }
+            const double* S = &total[p*p];
+            for (int j = 0; j < p; j++){
+                for (int k = j; k < p; k++){
+                    double value = nh/(nh - 1.0)*(total[j*p + k] - S[j]*S[k]/nh);
+                    M[j*p + k] += value;
+                    if (k != j){
+                        M[k*p + j] += value;
+                    }
+                }
+            }
+        }
+        std::copy(&beta[t*p], &beta[t*p] + p, &coefficients[outcome][steps[t]*p]);
+    }
+    
+    pending[outcome].clear();
+}
+
+void StreamingRegression::estimate(int outcome, int step, double* beta, double* se){
+    
+    flush(outcome);
+    if (singular){
+        for (int j = 0; j < p; j++){
+            beta[j] = se[j] = std::numeric_limits<double>::quiet_NaN();
+        }
+        return;
+    }
+    
+    //Covariance (X'WX)^-1 meat (X'WX)^-1
+    const double* M = &meat[outcome][step*p*p];
+    for (int j = 0; j < p; j++){
+        beta[j] = coefficients[outcome][step*p + j];
+        double variance = 0.0;
+        for (int l = 0; l < p; l++){
+            double half = 0.0;
+            for (int k = 0; k < p; k++){
+                half += inverse[j*p + k]*M[k*p + l];
+            }
+            variance += half*inverse[l*p + j];
+        }
+        se[j] = sqrt(std::max(variance, 0.0));
+    }
+}
@@ -0,0 +1,101 @@
+//
+//  streaming_regression.h
+//
+//  Weighted least squares of outcomes of the model (e.g. the change in body
+//  weight) on baseline covariates at every step, with sandwich (survey)
+//  standard errors, computed as the model runs so that the trajectories are
+//  not stored. The covariates X and weights w are fixed so X'WX and its
+//  inverse are computed once. The values of each step wait in a buffer of a
+//  few steps; when it is full the threads (each with a range of whole
+//  clusters) add X'Wy of each step, which gives its coefficients b, and
+//  then the scores s = sum w x (y - x'b) of each cluster (or individual)
+//  to the sum of s s' of its stratum. Only b and the sandwich of each step
+//  are kept so, besides the buffer, memory depends on the number of
+//  covariates and steps but not on the number of individuals.
+//
+//  Example:
+//      StreamingRegression reg(X, w, strata, cluster, n, p, nsteps, noutcomes, true, threads);
+//      for (int t = 0; t < nsteps; t++){
+//          reg.add(0, t, y);
+//      }
+//      reg.estimate(0, t, beta, se);
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef streaming_regression_h
+#define streaming_regression_h
+
+#include <vector>
+
+class StreamingRegression {
+public:
+    
+    //X is n x p by column; strata (0 to H - 1) and cluster (0 to G - 1) may be
+    //NULL for a single stratum and one cluster per individual. With change
+    //the outcome is its difference with the first step added.
+    StreamingRegression(const double* X, const double* w, const int* strata, const int* cluster,
+                        int n, int p, int nsteps, int noutcomes, bool change, int threads);
+    
+    int covariates(void) const { return p; }
+    
+    //Degrees of freedom of the design: clusters (or individuals) minus strata
+    int df(void) const { return npsu - nstrata; }
+    
+    //Adds the n values of outcome at step
+    void add(int outcome, int step, const double* y);
+    
+    //Coefficients and standard errors of outcome at step (NaN if X'WX is singular)
+    void estimate(int outcome, int step, double* beta, double* se);
+    
+private:
+    
+    //Coefficients and sandwich of the steps waiting in the buffer of outcome
+    void flush(int outcome);
+    
+    int n, p, nsteps, noutcomes, nstrata, nclusters, npsu, threads;
+    bool change;
+    
+    //Covariates by row, weights, stratum and cluster of each individual, in
+    //the order of the clusters so that each thread takes whole clusters
+    std::vector<double> X;
+    std::vector<double> w;
+    std::vector<int>    order, strata, cluster;
+    std::vector<int>    psuInStratum;
+    
+    //(X'WX)^-1
+    std::vector<double> inverse;
+    bool singular;
+    
+    //Coefficients and sum over the strata of nh/(nh - 1) sum (s - mean s)(s - mean s)'
+    //of each outcome and step, baseline of the outcome and steps waiting in the buffer
+    std::vector<std::vector<double> > coefficients;
+    std::vector<std::vector<double> > meat;
+    std::vector<std::vector<double> > baseline;
+    std::vector<std::vector<double> > buffer;
+    std::vector<std::vector<int> >    pending;
+    int block;
+};
+
+#endif /* streaming_regression_h */
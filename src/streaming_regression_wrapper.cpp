@@ -0,0 +1,62 @@
+//
+//  streaming_regression_wrapper.cpp
+//
+//  Regressions of the stored trajectories of a model on baseline covariates
+//  in one pass (see streaming_regression.h).
+//
+//  Input:
+//  model           .-  Result of the model (trajectories by step).
+//  regression      .-  Covariates, weights, strata, clusters and variables
+//                      checked by regression_control.
+//  TIME            .-  Time of each step.
+//  threads         .-  Threads of the regressions (0 for the budget).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include "trajectory_recorder.h"
+using namespace Rcpp;
+
+// [[Rcpp::export]]
+List regression_wrapper(List model, List regression, NumericVector TIME, int threads){
+    
+    //Recorder that only accumulates the regressions of every step
+    CharacterVector variables = regression["variables"];
+    NumericMatrix first       = model[as<std::string>(variables(0))];
+    List control = List::create(Named("regression") = regression, Named("threads") = threads);
+    TrajectoryRecorder recorder(first.nrow(), TIME.size() - 1, control);
+    
+    for (int v = 0; v < variables.size(); v++){
+        std::string name = as<std::string>(variables(v));
+        NumericMatrix Y  = model[name];
+        if (Y.nrow() != first.nrow() || Y.ncol() != TIME.size()){
+            stop("Invalid variable " + name + ": it must have one row per individual and one column per step.");
+        }
+        for (int i = 0; i < Y.ncol(); i++){
+            recorder.regress(name.c_str(), i, Y(_, i));
+        }
+    }
+    
+    return recorder.regressions(TIME);
+}
@@ -0,0 +1,271 @@
+//
+//  thread_governor.cpp
+//
+//  Thread budget and shared pool of the process (see thread_governor.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include "thread_governor.h"
+
+//Pool of worker threads taking tasks from a queue
+//--------------------------------------------------------------------------------
+class ThreadPool {
+public:
+    
+    //Workers are only added (up to the budget)
+    void reserve(int nworkers){
+        std::lock_guard<std::mutex> lock(mutex);
+        while ((int) workers.size() < nworkers){
+            workers.push_back(std::thread(&ThreadPool::loop, this));
+        }
+    }
+    
+    void submit(const std::function<void()>& task){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(task);
+        }
+        ready.notify_one();
+    }
+    
+    //Runs the tasks left and joins the workers. The pool lives until the
+    //package is unloaded (or is abandoned in a forked child where its threads
+    //do not exist).
+    void stop(void){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (size_t w = 0; w < workers.size(); w++){
+            workers[w].join();
+        }
+        workers.clear();
+    }
+    
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+    std::deque<std::function<void()> > tasks;
+    std::vector<std::thread> workers;
+    
+    void loop(void);
+};
+
+//Whether the current thread is a worker of the pool
+static thread_local bool inPool = false;
+
+void ThreadPool::loop(void){
+    inPool = true;
+    for (;;){
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [this]{ return !tasks.empty() || stopping; });
+            if (tasks.empty()){
+                return;
+            }
+            task = tasks.front();
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+//State of the process
+//--------------------------------------------------------------------------------
+static std::mutex governor;          //Guards the pool and the budget
+static ThreadPool* pool = NULL;
+static int  rBudget     = 0;         //From R (0 = not set)
+static long rProcess    = 0;         //Process where R set it (0 = unknown)
+static bool worker      = false;     //Socket worker of a cluster
+static bool forked      = false;     //Child of fork()
+
+#ifndef _WIN32
+//The forking thread holds the governor so that the child does not inherit it
+//locked by a thread that does not exist there. The pool of the parent is
+//abandoned in the child (its threads were not copied).
+static void prepareFork(void){ governor.lock(); }
+static void parentFork(void){ governor.unlock(); }
+static void childFork(void){
+    pool   = NULL;
+    forked = true;
+    governor.unlock();
+}
+static const int forkHandlers = pthread_atfork(prepareFork, parentFork, childFork);
+#endif
+
+static long currentProcess(void){
+#ifndef _WIN32
+    return (long) getpid();
+#else
+    return 0;
+#endif
+}
+
+static int defaultBudget(void){
+    
+    const char* env = getenv("BW_NUM_THREADS");
+    if (env != NULL && atoi(env) > 0){
+        return atoi(env);
+    }
+    
+    //The option of R is copied by fork: it only counts in the process that set it
+    const bool here = rProcess != 0 ? rProcess == currentProcess() : !forked;
+    if (rBudget > 0 && here){
+        return rBudget;
+    }
+    if (forked || worker){
+        return 1;
+    }
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+int threadBudget(int requested){
+    std::lock_guard<std::mutex> lock(governor);
+    const int budget = defaultBudget();
+    return requested > 0 ? std::min(requested, budget) : budget;
+}
+
+void setThreadBudget(int budget, long process, bool isWorker){
+    std::lock_guard<std::mutex> lock(governor);
+    rBudget  = std::max(0, budget);
+    rProcess = process;
+    worker   = isWorker;
+}
+
+void stopThreadPool(void){
+    ThreadPool* stopped;
+    {
+        std::lock_guard<std::mutex> lock(governor);
+        stopped = pool;
+        pool    = NULL;
+    }
+    if (stopped != NULL){
+        stopped->stop();
+        delete stopped;
+    }
+}
+
+//Parallel loop
+//--------------------------------------------------------------------------------
+struct ParallelJob {
+    ParallelJob(int n, const std::function<void(int)>& body) :
+        n(n), body(body), next(0), active(0), closed(false){}
+    
+    int n;
+    std::function<void(int)> body;
+    std::atomic<int> next;
+    
+    std::mutex mutex;
+    std::condition_variable done;
+    int  active;                   //Helpers running the loop
+    bool closed;                   //No more helpers may join
+    std::exception_ptr error;
+    
+    void run(void){
+        try {
+            for (int i = next++; i < n; i = next++){
+                body(i);
+            }
+        } catch (...){
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error){
+                error = std::current_exception();
+            }
+            next = n;
+        }
+    }
+};
+
+void parallelFor(int n, int nthreads, const std::function<void(int)>& body){
+    
+    //Serial when asked for, when there is one item or inside another region
+    nthreads = std::min(nthreads, n);
+    if (nthreads <= 1 || inPool){
+        for (int i = 0; i < n; i++){
+            body(i);
+        }
+        return;
+    }
+    
+    //Pool bounded by the budget: concurrent regions share its workers
+    ThreadPool* shared;
+    {
+        std::lock_guard<std::mutex> lock(governor);
+        if (pool == NULL){
+            pool = new ThreadPool();
+        }
+        pool->reserve(defaultBudget() - 1);
+        shared = pool;
+    }
+    
+    std::shared_ptr<ParallelJob> job = std::make_shared<ParallelJob>(n, body);
+    for (int w = 1; w < nthreads; w++){
+        shared->submit([job](){
+            {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (job->closed){
+                    return;
+                }
+                job->active++;
+            }
+            job->run();
+            std::lock_guard<std::mutex> lock(job->mutex);
+            if (--job->active == 0){
+                job->done.notify_all();
+            }
+        });
+    }
+    
+    //The caller works too and then waits only for the helpers that started;
+    //helpers still queued (pool busy with other regions) will find it closed
+    job->run();
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->closed = true;
+    job->done.wait(lock, [&job]{ return job->active == 0; });
+    
+    //The error leaves the job (a queued helper may release it last)
+    std::exception_ptr error;
+    std::swap(error, job->error);
+    lock.unlock();
+    if (error){
+        std::rethrow_exception(error);
+    }
+}
@@ -0,0 +1,67 @@
+//
+//  thread_governor.h
+//
+//  Process wide budget of threads and the pool shared by the parallel parts
+//  of the models (Parareal, intake estimation). The models are often called
+//  from already parallel R code (parallel::mclapply, future, foreach) so each
+//  process must use few threads; the budget is, in order:
+//      1. The environment variable BW_NUM_THREADS.
+//      2. The R option bw.threads set in this process (see bw_threads in R);
+//         forked children do not take the one they inherit.
+//      3. One thread in forked children (mclapply, future's multicore) and in
+//         socket workers (parallel::makeCluster, future's multisession).
+//      4. All the cores.
+//  Parallel regions never use more threads than the budget even when they
+//  run at the same time or inside each other (nested regions run serially).
+//  The pool is dropped in forked children and started again on first use.
+//
+//  Example:
+//      int nthreads = threadBudget(requested);
+//      parallelFor(n, nthreads, [&](int i){ results[i] = work(i); });
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef thread_governor_h
+#define thread_governor_h
+
+#include <functional>
+
+//Threads a parallel region may use: requested (0 for as many as possible)
+//bounded by the budget of the process
+int threadBudget(int requested = 0);
+
+//Budget set from R (0 to go back to the default), the process where it was
+//set (0 if unknown) and whether the process is a worker of a cluster
+void setThreadBudget(int budget, long process, bool worker);
+
+//Joins the threads of the pool (before the package is unloaded). A later
+//parallel region starts a new pool.
+void stopThreadPool(void);
+
+//Calls body(i) for i = 0..n-1 with at most nthreads threads of the shared
+//pool (the calling thread included). body must not call R.
+void parallelFor(int n, int nthreads, const std::function<void(int)>& body);
+
+#endif /* thread_governor_h */
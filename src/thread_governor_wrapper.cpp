@@ -0,0 +1,47 @@
+//
+//  thread_governor_wrapper.cpp
+//
+//  Thread budget of the process from R (see thread_governor.h).
+//
+//  Input:
+//  budget          .-  Threads set by the R option bw.threads (0 if not set).
+//  process         .-  Process id where the option was set (0 if unknown).
+//  worker          .-  Whether R is a worker of a socket cluster.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include "thread_governor.h"
+using namespace Rcpp;
+
+// [[Rcpp::export]]
+int thread_budget_wrapper(int budget, double process, bool worker){
+    setThreadBudget(budget, (long) process, worker);
+    return threadBudget();
+}
+
+// [[Rcpp::export]]
+void thread_pool_stop_wrapper(){
+    stopThreadPool();
+}
@@ -0,0 +1,326 @@
+//
+//  trajectory_recorder.cpp
+//
+//  Storage of the trajectories of all or a sample of the individuals
+//  (see trajectory_recorder.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <math.h>
+#include "thread_governor.h"
+#include "trajectory_recorder.h"
+
+TrajectoryRecorder::TrajectoryRecorder(int nind, int nsims, List control) :
+    nind(nind), nsims(nsims), sample(control.containsElementNamed("retain")){
+    
+    if (sample){
+        IntegerVector retain = control["retain"];
+        for (int r = 0; r < retain.size(); r++){
+            if (retain(r) < 0 || retain(r) >= nind){
+                stop("Invalid control$retain: individuals must be between 1 and the number of individuals.");
+            }
+            rows.push_back(retain(r));
+        }
+    } else {
+        for (int r = 0; r < nind; r++){
+            rows.push_back(r);
+        }
+    }
+    
+    //Covariates (one row per individual), weights and optional strata and
+    //clusters (from 0) of the regressions checked in R (regression_control)
+    if (control.containsElementNamed("regression")){
+        List options         = control["regression"];
+        NumericMatrix X      = options["X"];
+        NumericVector w      = options["weights"];
+        IntegerVector strata = options.containsElementNamed("strata") ?
+            as<IntegerVector>(options["strata"]) : IntegerVector(0);
+        IntegerVector cluster = options.containsElementNamed("cluster") ?
+            as<IntegerVector>(options["cluster"]) : IntegerVector(0);
+        if (X.nrow() != nind || w.size() != nind){
+            stop("Invalid control$regression: covariates and weights must have one row per individual.");
+        }
+        regressionVariables  = options["variables"];
+        regressionCovariates = options["covariates"];
+        regression = std::make_shared<StreamingRegression>(X.begin(), w.begin(),
+            strata.size() ? strata.begin() : (int*) NULL, cluster.size() ? cluster.begin() : (int*) NULL,
+            nind, X.ncol(), nsims + 1, regressionVariables.size(),
+            as<bool>(options["change"]), threadBudget(controlValue(control, "threads", 0)));
+    }
+    
+    //Relative risk tables, hazards (one row per individual), weights and
+    //groups (from 0) of the diseases checked in R (risk_control)
+    if (control.containsElementNamed("risk")){
+        List options     = control["risk"];
+        List knots       = options["bmi"];
+        List values      = options["log_rr"];
+        NumericMatrix h0 = options["hazard"];
+        NumericVector w  = options["weights"];
+        IntegerVector g  = options["group"];
+        riskDiseases     = options["diseases"];
+        riskGroups       = options["groups"];
+        riskCost         = options["cost"];
+        if (h0.nrow() != nind || h0.ncol() != knots.size() || w.size() != nind || g.size() != nind){
+            stop("Invalid control$risk: hazards, weights and groups must have one row per individual.");
+        }
+        std::vector<std::vector<double> > bmi, logRR;
+        for (int d = 0; d < knots.size(); d++){
+            bmi.push_back(as<std::vector<double> >(knots[d]));
+            logRR.push_back(as<std::vector<double> >(values[d]));
+        }
+        risk = std::make_shared<DiseaseRisk>(bmi, logRR, h0.begin(), w.begin(), g.begin(),
+            nind, riskGroups.size(), nsims + 1, controlValue(options, "step", 1.0/365.0),
+            threadBudget(controlValue(control, "threads", 0)));
+    }
+    
+    //Monitor created by bw_async before the run was forked
+    if (control.containsElementNamed("monitor")){
+        XPtr<std::shared_ptr<RunMonitor> > ptr(as<SEXP>(control["monitor"]));
+        monitor = *ptr;
+        monitor->start(nind, nsims + 1);
+    }
+}
+
+IntegerVector TrajectoryRecorder::retained() const {
+    IntegerVector ids(size());
+    for (int r = 0; r < size(); r++){
+        ids(r) = rows[r] + 1;
+    }
+    return ids;
+}
+
+TrajectoryRecorder::Moments& TrajectoryRecorder::moments(const char* name){
+    for (size_t v = 0; v < numeric.size(); v++){
+        if (numeric[v].name.compare(name) == 0){
+            return numeric[v];
+        }
+    }
+    Moments m;
+    m.name = name;
+    m.n.assign(nsims + 1, 0.0);
+    m.mean.assign(nsims + 1, 0.0);
+    m.m2.assign(nsims + 1, 0.0);
+    numeric.push_back(m);
+    return numeric.back();
+}
+
+TrajectoryRecorder::Counts& TrajectoryRecorder::counts(const char* name){
+    for (size_t v = 0; v < categorical.size(); v++){
+        if (categorical[v].name.compare(name) == 0){
+            return categorical[v];
+        }
+    }
+    Counts c;
+    c.name = name;
+    categorical.push_back(c);
+    return categorical.back();
+}
+
+void TrajectoryRecorder::record(NumericMatrix M, const char* name, int step, NumericVector x){
+    
+    watch(name, step, x);
+    regress(name, step, x);
+    assess(name, step, x);
+    
+    if (!sample){
+        M(_,step) = x;
+        return;
+    }
+    
+    for (int r = 0; r < size(); r++){
+        M(r,step) = x(rows[r]);
+    }
+    
+    Moments& m = moments(name);
+    for (int i = 0; i < nind; i++){
+        m.n[step]   += 1.0;
+        double d     = x(i) - m.mean[step];
+        m.mean[step] += d/m.n[step];
+        m.m2[step]  += d*(x(i) - m.mean[step]);
+    }
+}
+
+void TrajectoryRecorder::record(StringMatrix M, const char* name, int step, StringVector x){
+    
+    if (!sample){
+        M(_,step) = x;
+        return;
+    }
+    
+    for (int r = 0; r < size(); r++){
+        M(r,step) = x(rows[r]);
+    }
+    
+    aggregate(name, step, x);
+}
+
+void TrajectoryRecorder::aggregate(const char* name, int step, StringVector x){
+    
+    if (!sample){
+        return;
+    }
+    
+    Counts& c = counts(name);
+    for (int i = 0; i < nind; i++){
+        std::string value = as<std::string>(x(i));
+        size_t k = 0;
+        while (k < c.category.size() && c.category[k].compare(value) != 0){
+            k++;
+        }
+        if (k == c.category.size()){
+            c.category.push_back(value);
+            c.n.push_back(std::vector<double>(nsims + 1, 0.0));
+        }
+        c.n[k][step] += 1.0;
+    }
+}
+
+List TrajectoryRecorder::aggregates(NumericVector TIME) const {
+    
+    List result;
+    result.push_back(TIME, "Time");
+    result.push_back(nind, "N");
+    
+    for (size_t v = 0; v < numeric.size(); v++){
+        const Moments& m = numeric[v];
+        NumericVector MEAN(nsims + 1), SD(nsims + 1);
+        for (int i = 0; i <= nsims; i++){
+            MEAN(i) = m.mean[i];
+            SD(i)   = m.n[i] > 1 ? sqrt(m.m2[i]/(m.n[i] - 1.0)) : NA_REAL;
+        }
+        result.push_back(List::create(Named("Mean") = MEAN, Named("SD") = SD), m.name);
+    }
+    
+    for (size_t v = 0; v < categorical.size(); v++){
+        const Counts& c = categorical[v];
+        List proportions;
+        for (size_t k = 0; k < c.category.size(); k++){
+            NumericVector P(nsims + 1);
+            for (int i = 0; i <= nsims; i++){
+                P(i) = c.n[k][i]/nind;
+            }
+            proportions.push_back(P, c.category[k]);
+        }
+        result.push_back(proportions, c.name);
+    }
+    
+    return result;
+}
+
+void TrajectoryRecorder::regress(const char* name, int step, NumericVector x){
+    
+    if (!regressing()){
+        return;
+    }
+    for (int v = 0; v < regressionVariables.size(); v++){
+        if (as<std::string>(regressionVariables(v)).compare(name) == 0){
+            regression->add(v, step, x.begin());
+        }
+    }
+}
+
+List TrajectoryRecorder::regressions(NumericVector TIME){
+    
+    List result;
+    result.push_back(TIME, "Time");
+    result.push_back(regression->df(), "df");
+    
+    int p = regression->covariates();
+    std::vector<double> beta(p), se(p);
+    for (int v = 0; v < regressionVariables.size(); v++){
+        NumericMatrix ESTIMATE(nsims + 1, p), SE(nsims + 1, p);
+        for (int i = 0; i <= nsims; i++){
+            regression->estimate(v, i, &beta[0], &se[0]);
+            for (int j = 0; j < p; j++){
+                ESTIMATE(i, j) = beta[j];
+                SE(i, j)       = se[j];
+            }
+        }
+        colnames(ESTIMATE) = regressionCovariates;
+        colnames(SE)       = regressionCovariates;
+        result.push_back(List::create(Named("Estimate") = ESTIMATE, Named("SE") = SE),
+                         as<std::string>(regressionVariables(v)));
+    }
+    
+    return result;
+}
+
+void TrajectoryRecorder::watch(const char* name, int step, NumericVector x){
+    
+    if (monitor.get() == NULL){
+        return;
+    }
+    if (monitor->cancelled()){
+        stop("The run was cancelled.");
+    }
+    monitor->record(name, step, x.begin(), x.size());
+}
+
+void TrajectoryRecorder::assess(const char* name, int step, NumericVector x){
+    
+    if (assessing() && std::string(name).compare("Body_Mass_Index") == 0){
+        risk->add(step, x.begin());
+    }
+}
+
+List TrajectoryRecorder::risks(NumericVector TIME) const {
+    
+    List result;
+    result.push_back(TIME, "Time");
+    
+    int ngroups = risk->groups();
+    for (int d = 0; d < risk->diseases(); d++){
+        NumericMatrix CASES(nsims + 1, ngroups), BASELINE(nsims + 1, ngroups), AVERTED(nsims + 1, ngroups);
+        for (int i = 0; i <= nsims; i++){
+            for (int g = 0; g < ngroups; g++){
+                CASES(i, g)    = risk->cases(d, i, g);
+                BASELINE(i, g) = risk->baseline(d, i, g);
+                AVERTED(i, g)  = BASELINE(i, g) - CASES(i, g);
+            }
+        }
+        colnames(CASES)    = riskGroups;
+        colnames(BASELINE) = riskGroups;
+        colnames(AVERTED)  = riskGroups;
+        List disease = List::create(Named("Cases") = CASES, Named("Baseline") = BASELINE,
+                                    Named("Averted") = AVERTED);
+        
+        //Costs of the cases and savings of those averted
+        if (!ISNAN(riskCost(d))){
+            NumericMatrix COSTS(nsims + 1, ngroups), SAVINGS(nsims + 1, ngroups);
+            for (int i = 0; i <= nsims; i++){
+                for (int g = 0; g < ngroups; g++){
+                    COSTS(i, g)   = riskCost(d)*CASES(i, g);
+                    SAVINGS(i, g) = riskCost(d)*AVERTED(i, g);
+                }
+            }
+            colnames(COSTS)   = riskGroups;
+            colnames(SAVINGS) = riskGroups;
+            disease.push_back(COSTS, "Costs");
+            disease.push_back(SAVINGS, "Savings");
+        }
+        result.push_back(disease, as<std::string>(riskDiseases(d)));
+    }
+    
+    return result;
+}
@@ -0,0 +1,158 @@
+//
+//  trajectory_recorder.h
+//
+//  Storage of the trajectories computed by the models. By default every
+//  individual is stored. When control$retain has the individuals (from 0)
+//  to keep, only their trajectories are stored and the mean and standard
+//  deviation over all the individuals (and the proportion in each category)
+//  are accumulated at each step so memory depends on the retained sample.
+//  When control$regression has baseline covariates, the weighted regression
+//  of the variables listed on them is also accumulated at each step (see
+//  streaming_regression.h), whether or not the individuals are stored.
+//  When control$risk has relative risk tables, the expected cases of each
+//  disease are accumulated from the BMI of each step (see disease_risk.h).
+//  When control$monitor has the monitor of a background run, the mean and
+//  SD of each step are published to it and the run stops once it is
+//  cancelled (see run_monitor.h).
+//
+//  Example:
+//      TrajectoryRecorder recorder(nind, nsims, control);
+//      NumericMatrix BW = recorder.matrix<NumericMatrix>(control, "Body_Weight");
+//      for (int i = 0; i <= nsims; i++){
+//          recorder.record(BW, "Body_Weight", i, bw);
+//      }
+//      result.push_back(recorder.aggregates(TIME), "Aggregates");
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef trajectory_recorder_h
+#define trajectory_recorder_h
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <Rcpp.h>
+#include "control.h"
+#include "streaming_regression.h"
+#include "disease_risk.h"
+#include "run_monitor.h"
+using namespace Rcpp;
+
+class TrajectoryRecorder {
+public:
+    
+    TrajectoryRecorder(int nind, int nsims, List control);
+    
+    //Whether only a sample is stored
+    bool sampled() const { return sample; }
+    
+    //Number of individuals stored
+    int size() const { return rows.size(); }
+    
+    //Individuals stored (from 1 as in R)
+    IntegerVector retained() const;
+    
+    //Individuals stored (from 0)
+    const std::vector<int>& individuals() const { return rows; }
+    
+    //Matrix for the stored individuals (see outputMatrix in control.h)
+    template <typename T>
+    T matrix(List control, const char* name) const {
+        return outputMatrix<T>(control, name, size(), nsims + 1);
+    }
+    
+    //Stores the value of the retained individuals at step and adds all of
+    //them to the aggregates of name (only when sampled)
+    void record(NumericMatrix M, const char* name, int step, NumericVector x);
+    void record(StringMatrix M, const char* name, int step, StringVector x);
+    
+    //Adds x to the proportions of each category of name without storing it
+    void aggregate(const char* name, int step, StringVector x);
+    
+    //Mean and SD of each variable and proportion of each category by step
+    List aggregates(NumericVector TIME) const;
+    
+    //Adds x to the regressions of name (if it is one of their variables)
+    void regress(const char* name, int step, NumericVector x);
+    
+    //Whether control$regression was given
+    bool regressing() const { return regression.get() != NULL; }
+    
+    //Coefficients and standard errors of each variable by step
+    List regressions(NumericVector TIME);
+    
+    //Adds x to the cumulative hazards of the diseases (if name is the BMI)
+    void assess(const char* name, int step, NumericVector x);
+    
+    //Whether control$risk was given
+    bool assessing() const { return risk.get() != NULL; }
+    
+    //Expected, baseline and averted cases (and costs) of each disease by step
+    List risks(NumericVector TIME) const;
+    
+    //Publishes x to the monitor of a background run (and stops if it was cancelled)
+    void watch(const char* name, int step, NumericVector x);
+    
+private:
+    
+    //Mean and sum of squared deviations of each step (Welford's algorithm)
+    struct Moments {
+        std::string name;
+        std::vector<double> n, mean, m2;
+    };
+    
+    //Individuals in each category at each step
+    struct Counts {
+        std::string name;
+        std::vector<std::string> category;
+        std::vector<std::vector<double> > n;
+    };
+    
+    Moments& moments(const char* name);
+    Counts&  counts(const char* name);
+    
+    int  nind;
+    int  nsims;
+    bool sample;
+    std::vector<int>     rows;
+    std::vector<Moments> numeric;
+    std::vector<Counts>  categorical;
+    
+    //Regressions of control$regression on its covariates
+    std::shared_ptr<StreamingRegression> regression;
+    CharacterVector regressionVariables;
+    CharacterVector regressionCovariates;
+    
+    //Expected cases of the diseases of control$risk by group
+    std::shared_ptr<DiseaseRisk> risk;
+    CharacterVector riskDiseases;
+    CharacterVector riskGroups;
+    NumericVector   riskCost;
+    
+    //Monitor of control$monitor shared with the session that started the run
+    std::shared_ptr<RunMonitor> monitor;
+};
+
+#endif /* trajectory_recorder_h */
@@ -0,0 +1,317 @@
+//
+//  zone_map.cpp
+//
+//  Zone maps and the filters and aggregates that use them (see zone_map.h).
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <vector>
+#include "zone_map.h"
+#include "output_layout.h"
+
+//Values of a numeric trajectory by individual and step in any layout
+class Trajectory {
+public:
+    Trajectory(RObject x) : layout(layoutOf(x)){
+        if (TYPEOF(x) != REALSXP){
+            stop("Zone maps are only available for numeric trajectories.");
+        }
+        values = x;
+        IntegerVector dim = trajectoryDim(x);
+        nrow = dim(0);
+        ncol = dim(1);
+    }
+    
+    double operator()(int i, int s) const {
+        return values[layout.offset(i, s, nrow, ncol)];
+    }
+    
+    NumericVector values;
+    OutputLayout  layout;
+    int nrow, ncol;
+};
+
+//Zone map given by zoneMap
+class ZoneBlocks {
+public:
+    ZoneBlocks(List map, const Trajectory& x){
+        IntegerVector block = map["block"];
+        rows  = block(0);
+        cols  = block(1);
+        Min   = map["Min"];
+        Max   = map["Max"];
+        Sum   = map["Sum"];
+        Count = map["Count"];
+        if (Min.nrow() != (x.nrow + rows - 1)/rows || Min.ncol() != (x.ncol + cols - 1)/cols){
+            stop("The zone map does not match the trajectory.");
+        }
+    }
+    
+    //Individuals (steps) of block b, from first to the one before last
+    int firstRow(int b) const { return b*rows; }
+    int firstCol(int b) const { return b*cols; }
+    
+    int rows, cols;
+    NumericMatrix Min, Max, Sum, Count;
+};
+
+enum Comparison {GREATER, GREATER_EQUAL, LESS, LESS_EQUAL};
+
+static Comparison comparison(std::string op){
+    if (op.compare(">") == 0){
+        return GREATER;
+    } else if (op.compare(">=") == 0){
+        return GREATER_EQUAL;
+    } else if (op.compare("<") == 0){
+        return LESS;
+    } else if (op.compare("<=") == 0){
+        return LESS_EQUAL;
+    }
+    stop("Invalid op '" + op + "'. Please choose '>', '>=', '<' or '<='.");
+    return GREATER;
+}
+
+//Whether value op threshold (false for NaN)
+static inline bool holds(double value, Comparison op, double threshold){
+    switch (op){
+        case GREATER:       return value > threshold;
+        case GREATER_EQUAL: return value >= threshold;
+        case LESS:          return value < threshold;
+        default:            return value <= threshold;
+    }
+}
+
+static void checkSteps(const Trajectory& x, int first, int last){
+    if (first < 0 || last < first || last >= x.ncol){
+        stop("Invalid steps: they must be within the trajectory.");
+    }
+}
+
+List zoneMap(RObject input, int blockRows, int blockCols){
+    
+    if (blockRows < 1 || blockCols < 1){
+        stop("Invalid block: it must have at least one individual and one step.");
+    }
+    
+    const Trajectory x(input);
+    const int nbr = (x.nrow + blockRows - 1)/blockRows;
+    const int nbc = (x.ncol + blockCols - 1)/blockCols;
+    
+    NumericMatrix Min(nbr, nbc), Max(nbr, nbc), Sum(nbr, nbc), Count(nbr, nbc);
+    for (int bs = 0; bs < nbc; bs++){
+        const int s1 = std::min(x.ncol, (bs + 1)*blockCols);
+        for (int bi = 0; bi < nbr; bi++){
+            const int i1 = std::min(x.nrow, (bi + 1)*blockRows);
+            double low = R_PosInf, high = R_NegInf, sum = 0.0, count = 0.0;
+            for (int s = bs*blockCols; s < s1; s++){
+                for (int i = bi*blockRows; i < i1; i++){
+                    const double v = x(i, s);
+                    if (ISNAN(v)){
+                        continue;
+                    }
+                    low   = std::min(low, v);
+                    high  = std::max(high, v);
+                    sum  += v;
+                    count++;
+                }
+            }
+            Min(bi, bs) = low; Max(bi, bs) = high; Sum(bi, bs) = sum; Count(bi, bs) = count;
+        }
+    }
+    
+    return List::create(Named("block") = IntegerVector::create(blockRows, blockCols),
+                        Named("Min")   = Min,
+                        Named("Max")   = Max,
+                        Named("Sum")   = Sum,
+                        Named("Count") = Count);
+}
+
+IntegerVector zoneQuery(RObject input, List map, std::string op, double threshold,
+                        std::string when, int first, int last){
+    
+    const Trajectory x(input);
+    const ZoneBlocks z(map, x);
+    const Comparison cmp = comparison(op);
+    checkSteps(x, first, last);
+    
+    const int bs0   = first/z.cols;
+    const int bs1   = last/z.cols;
+    const int total = z.Min.nrow()*(bs1 - bs0 + 1);
+    int scanned     = 0;
+    std::vector<int> rows;
+    
+    if (when.compare("change") == 0){
+        
+        //Only the first and last values of each individual are read
+        for (int i = 0; i < x.nrow; i++){
+            if (holds(x(i, last)/x(i, first) - 1.0, cmp, threshold)){
+                rows.push_back(i);
+            }
+        }
+        
+    } else if (when.compare("any") == 0 || when.compare("all") == 0){
+        
+        //decided: a value satisfies it (any) or one does not (all)
+        const bool any = when.compare("any") == 0;
+        std::vector<char> decided(x.nrow, 0);
+        
+        for (int bi = 0; bi < z.Min.nrow(); bi++){
+            
+            const int i0 = z.firstRow(bi);
+            const int i1 = std::min(x.nrow, i0 + z.rows);
+            int open     = i1 - i0;
+            
+            for (int bs = bs0; bs <= bs1 && open > 0; bs++){
+                
+                const double count = z.Count(bi, bs);
+                if (count == 0){
+                    continue;
+                }
+                
+                //When both ends of the range agree every value of the block
+                //does: nothing is decided by it (no value satisfies it for
+                //any, all do for all) or, if no value is missing, every
+                //individual of the block is
+                const bool low  = holds(z.Min(bi, bs), cmp, threshold);
+                const bool high = holds(z.Max(bi, bs), cmp, threshold);
+                const int  c0   = z.firstCol(bs);
+                const int  c1   = std::min(x.ncol, c0 + z.cols);
+                if (low == high && low != any){
+                    continue;
+                }
+                if (low == high && count == (double)(i1 - i0)*(c1 - c0)){
+                    std::fill(decided.begin() + i0, decided.begin() + i1, 1);
+                    open = 0;
+                    break;
+                }
+                
+                //Values of the individuals still open in the steps asked
+                scanned++;
+                const int s0 = std::max(first, c0);
+                const int s1 = std::min(last + 1, c1);
+                for (int i = i0; i < i1; i++){
+                    if (decided[i]){
+                        continue;
+                    }
+                    for (int s = s0; s < s1; s++){
+                        const double v = x(i, s);
+                        if (!ISNAN(v) && holds(v, cmp, threshold) == any){
+                            decided[i] = 1;
+                            open--;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        
+        for (int i = 0; i < x.nrow; i++){
+            if (decided[i] == any){
+                rows.push_back(i);
+            }
+        }
+        
+    } else {
+        stop("Invalid when '" + when + "'. Please choose 'any', 'all' or 'change'.");
+    }
+    
+    IntegerVector result(rows.begin(), rows.end());
+    result.attr("blocks") = IntegerVector::create(scanned, total);
+    return result;
+}
+
+List zoneSummary(RObject input, List map, IntegerVector rows, int first, int last){
+    
+    const Trajectory x(input);
+    const ZoneBlocks z(map, x);
+    checkSteps(x, first, last);
+    
+    //Individuals asked of each block of individuals
+    std::vector<char> selected(x.nrow, 0);
+    std::vector<int>  nselected(z.Min.nrow(), 0);
+    for (int k = 0; k < rows.size(); k++){
+        if (rows(k) < 0 || rows(k) >= x.nrow){
+            stop("Invalid individuals: they must be rows of the trajectory.");
+        }
+        if (!selected[rows(k)]){
+            selected[rows(k)] = 1;
+            nselected[rows(k)/z.rows]++;
+        }
+    }
+    
+    const int bs0 = first/z.cols;
+    const int bs1 = last/z.cols;
+    double low = R_PosInf, high = R_NegInf, sum = 0.0, count = 0.0;
+    int scanned = 0;
+    
+    for (int bi = 0; bi < z.Min.nrow(); bi++){
+        
+        if (nselected[bi] == 0){
+            continue;
+        }
+        const int i0 = z.firstRow(bi);
+        const int i1 = std::min(x.nrow, i0 + z.rows);
+        
+        for (int bs = bs0; bs <= bs1; bs++){
+            
+            const int c0 = z.firstCol(bs);
+            const int c1 = std::min(x.ncol, c0 + z.cols);
+            const int s0 = std::max(first, c0);
+            const int s1 = std::min(last + 1, c1);
+            
+            //Whole block: its aggregates are in the map
+            if (nselected[bi] == i1 - i0 && s0 == c0 && s1 == c1){
+                if (z.Count(bi, bs) > 0){
+                    low    = std::min(low, z.Min(bi, bs));
+                    high   = std::max(high, z.Max(bi, bs));
+                    sum   += z.Sum(bi, bs);
+                    count += z.Count(bi, bs);
+                }
+                continue;
+            }
+            
+            scanned++;
+            for (int s = s0; s < s1; s++){
+                for (int i = i0; i < i1; i++){
+                    const double v = selected[i] ? x(i, s) : NA_REAL;
+                    if (ISNAN(v)){
+                        continue;
+                    }
+                    low   = std::min(low, v);
+                    high  = std::max(high, v);
+                    sum  += v;
+                    count++;
+                }
+            }
+        }
+    }
+    
+    return List::create(Named("Individuals") = (int) std::count(selected.begin(), selected.end(), 1),
+                        Named("Values")      = count,
+                        Named("Min")         = count > 0 ? low : NA_REAL,
+                        Named("Max")         = count > 0 ? high : NA_REAL,
+                        Named("Mean")        = count > 0 ? sum/count : NA_REAL,
+                        Named("Blocks")      = IntegerVector::create(scanned, z.Min.nrow()*(bs1 - bs0 + 1)));
+}
@@ -0,0 +1,65 @@
+//
+//  zone_map.h
+//
+//  Zone maps of the trajectories of a model: the trajectory (individuals by
+//  steps) is split in blocks of blockRows individuals by blockCols steps and
+//  the Min, Max, Sum and Count (values that are not NaN) of each block are
+//  kept. Filters on the values (e.g. BMI > 40 at any time) then skip the
+//  blocks whose range decides them and read only the others, and aggregates
+//  over whole blocks are taken from the map. Blocks are in individuals and
+//  steps so the map does not depend on the layout (see output_layout.h).
+//
+//  Example:
+//      List map = zoneMap(x, 64, 64);
+//      IntegerVector rows = zoneQuery(x, map, ">", 40, "any", 0, nsteps - 1);
+//      List stats = zoneSummary(x, map, rows, 0, nsteps - 1);
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef zone_map_h
+#define zone_map_h
+
+#include <string>
+#include <Rcpp.h>
+using namespace Rcpp;
+
+//Zone map of the numeric trajectory x: a list with the block size and the
+//Min, Max, Sum and Count of each block (one row per block of individuals and
+//one column per block of steps)
+List zoneMap(RObject x, int blockRows, int blockCols);
+
+//Individuals (rows from 0) whose values between steps first and last satisfy
+//"value op threshold" (op is ">", ">=", "<" or "<=") at some step
+//(when = "any") or at every step (when = "all"), or whose relative change
+//from step first to step last does (when = "change"). The blocks read and
+//the total are returned in the attribute "blocks".
+IntegerVector zoneQuery(RObject x, List map, std::string op, double threshold,
+                        std::string when, int first, int last);
+
+//Number of Individuals (rows from 0) and Values, Min, Max and Mean of their
+//values between steps first and last
+List zoneSummary(RObject x, List map, IntegerVector rows, int first, int last);
+
+#endif /* zone_map_h */
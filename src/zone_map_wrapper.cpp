@@ -0,0 +1,58 @@
+//
+//  zone_map_wrapper.cpp
+//
+//  Zone maps of the trajectories of a model and queries that use them
+//  to skip blocks (see zone_map.h).
+//
+//  Input:
+//  x               .-  Numeric trajectory of the model.
+//  block           .-  Individuals and steps of each block.
+//  map             .-  Zone map of x.
+//  op              .-  ">", ">=", "<" or "<=".
+//  value           .-  Value compared against.
+//  when            .-  "any", "all" or "change".
+//  rows            .-  Individuals (from 0) summarised.
+//  first, last     .-  Steps (from 0) considered.
+//
+//  Authors:
+//  Dalia Camacho-García-Formentí
+//  Rodrigo Zepeda-Tello
+//
+//----------------------------------------------------------------------------------------
+// License: MIT
+// Copyright 2018 Instituto Nacional de Salud Pública de México
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software
+// and associated documentation files (the "Software"), to deal in the Software without restriction,
+// including without limitation the rights to use, copy, modify, merge, publish, distribute,
+// sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+// is furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies
+// or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING
+// BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+// NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+// DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//----------------------------------------------------------------------------------------
+
+#include <Rcpp.h>
+#include "zone_map.h"
+using namespace Rcpp;
+
+// [[Rcpp::export]]
+List zone_map_wrapper(RObject x, IntegerVector block){
+    return zoneMap(x, block(0), block(1));
+}
+
+// [[Rcpp::export]]
+IntegerVector zone_query_wrapper(RObject x, List map, std::string op, double value,
+                                 std::string when, int first, int last){
+    return zoneQuery(x, map, op, value, when, first, last);
+}
+
+// [[Rcpp::export]]
+List zone_summary_wrapper(RObject x, List map, IntegerVector rows, int first, int last){
+    return zoneSummary(x, map, rows, first, last);
+}